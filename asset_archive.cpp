@@ -0,0 +1,95 @@
+#include "asset_archive.h"
+// C++ libraries
+#include <iostream>
+#include <cstring>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <iterator>
+#endif
+// namespaces
+using namespace std;
+
+AssetArchive::~AssetArchive()
+{
+#if !defined(_WIN32)
+    if (mapped)
+        munmap(const_cast<uint8_t*>(bytes), length);
+#endif
+}
+bool AssetArchive::open(const char path[])
+{
+#if !defined(_WIN32)
+    int file = ::open(path, O_RDONLY);
+    if (file < 0)
+    {
+        cerr << "Failed to open " << path << endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(file, &info) == 0 && info.st_size > 0)
+    {
+        void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapping != MAP_FAILED)
+        {
+            bytes = static_cast<const uint8_t*>(mapping);
+            length = static_cast<size_t>(info.st_size);
+            mapped = true;
+        }
+    }
+    close(file); // the mapping stays valid
+    if (!mapped)
+    {
+        cerr << "Failed to map " << path << endl;
+        return false;
+    }
+#else
+    ifstream inputFile(path, ios::binary);
+    if (!inputFile.is_open())
+    {
+        cerr << "Failed to open " << path << endl;
+        return false;
+    }
+    copy.assign(istreambuf_iterator<char>(inputFile), istreambuf_iterator<char>());
+    bytes = copy.data();
+    length = copy.size();
+#endif
+    // check the header and that every entry lies inside the file
+    const ArchiveHeader* header = reinterpret_cast<const ArchiveHeader*>(bytes);
+    if (length < sizeof(ArchiveHeader) || memcmp(header->magic, ARCHIVE_MAGIC, 4) != 0 ||
+        header->version != ARCHIVE_VERSION ||
+        header->entryCount > (length - sizeof(ArchiveHeader)) / sizeof(ArchiveEntry))
+    {
+        cerr << path << " is not a version " << ARCHIVE_VERSION << " asset archive" << endl;
+        return false;
+    }
+    entries = reinterpret_cast<const ArchiveEntry*>(bytes + sizeof(ArchiveHeader));
+    entryCount = header->entryCount;
+    for (uint32_t i = 0; i < entryCount; i++)
+    {
+        if (entries[i].offset > length || entries[i].size > length - entries[i].offset ||
+            entries[i].name[ARCHIVE_NAME_LENGTH - 1] != '\0')
+        {
+            cerr << path << " is damaged (entry " << i << ")" << endl;
+            return false;
+        }
+    }
+    return true;
+}
+const ArchiveEntry* AssetArchive::find(const char name[]) const
+{
+    for (uint32_t i = 0; i < entryCount; i++) // a couple of dozen entries, looked up once each
+    {
+        if (strcmp(entries[i].name, name) == 0)
+            return &entries[i];
+    }
+    return nullptr;
+}
+const uint8_t* AssetArchive::data(const ArchiveEntry& entry) const
+{
+    return bytes + entry.offset;
+}
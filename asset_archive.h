@@ -0,0 +1,64 @@
+#pragma once
+// Packed asset archive: every file the game needs in one assets.pak, built by tools/asset_packer.
+// The game maps the file once and hands SFML pointers straight into the mapping, so startup is one
+// open and no copies, whatever state the filesystem or the loose assets/ directory is in.
+//
+// Layout: ArchiveHeader, then entryCount ArchiveEntry records, then the data of every entry
+// (each aligned to ARCHIVE_ALIGNMENT). Entries are either the file bytes as they were on disk or,
+// when packed with --decoded, raw RGBA pixels / 16-bit PCM samples that need no decoding at all.
+// Little endian, like everything the game runs on.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const char ASSET_ARCHIVE_FILE[] = "assets.pak"; // relative to the working directory of the game
+const char ARCHIVE_MAGIC[4] = {'S', 'S', 'P', 'K'};
+const uint32_t ARCHIVE_VERSION = 1;
+const int ARCHIVE_NAME_LENGTH = 48;
+const int ARCHIVE_ALIGNMENT = 16;
+// Entry kinds
+const uint32_t ENTRY_FILE = 0; // bytes of the original file (PNG, TTF, MP3, WAV, ...)
+const uint32_t ENTRY_RGBA = 1; // width * height * 4 bytes of pixels
+const uint32_t ENTRY_PCM = 2;  // interleaved int16 samples
+
+struct ArchiveHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+struct ArchiveEntry
+{
+    char name[ARCHIVE_NAME_LENGTH]; // the path the game asks for, e.g. "assets/sounds/shoot.wav"
+    uint32_t kind;
+    uint32_t width;      // ENTRY_RGBA
+    uint32_t height;
+    uint32_t channels;   // ENTRY_PCM
+    uint32_t sampleRate;
+    uint32_t reserved;
+    uint64_t offset;     // from the start of the archive
+    uint64_t size;       // bytes
+};
+static_assert(sizeof(ArchiveHeader) == 16 && sizeof(ArchiveEntry) == 88, "archive layout is part of the file format");
+
+class AssetArchive
+{
+public:
+    AssetArchive() = default;
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+    ~AssetArchive();
+    // Map the archive and check its index. False (with a message) if it is missing or damaged
+    bool open(const char path[]);
+    const ArchiveEntry* find(const char name[]) const; // nullptr if it is not in the archive
+    const uint8_t* data(const ArchiveEntry& entry) const;
+
+private:
+    const uint8_t* bytes = nullptr;
+    size_t length = 0;
+    bool mapped = false;           // false: read into `copy` (no mmap on this platform)
+    std::vector<uint8_t> copy;
+    const ArchiveEntry* entries = nullptr;
+    uint32_t entryCount = 0;
+};
@@ -0,0 +1,145 @@
+#include "asset_loader.h"
+// C++ libraries
+#include <iostream>
+#include <cstdio>
+// namespaces
+using namespace std;
+using namespace sf;
+
+AssetLoader::AssetLoader(const AssetArchive& assetArchive) : archive(assetArchive)
+{
+}
+AssetLoader::~AssetLoader()
+{
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+    }
+}
+void AssetLoader::add(void* target, int kind, const char name[])
+{
+    AssetJob job = {name, kind, target, false, 0.0, 0};
+    jobs.push_back(job);
+}
+void AssetLoader::addImage(Image& image, const char name[])
+{
+    add(&image, ASSET_IMAGE, name);
+}
+void AssetLoader::addFont(Font& font, const char name[])
+{
+    add(&font, ASSET_FONT, name);
+}
+void AssetLoader::addMusic(Music& music, const char name[])
+{
+    add(&music, ASSET_MUSIC, name);
+}
+void AssetLoader::addSound(SoundBuffer& buffer, const char name[])
+{
+    add(&buffer, ASSET_SOUND, name);
+}
+void AssetLoader::start(int threadCount)
+{
+    startTime = chrono::steady_clock::now();
+    if (threadCount > static_cast<int>(jobs.size()))
+        threadCount = static_cast<int>(jobs.size());
+    if (threadCount < 1)
+        threadCount = 1;
+    threadsUsed = threadCount;
+    for (int i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back(&AssetLoader::workerLoop, this, i);
+    }
+}
+int AssetLoader::jobCount() const
+{
+    return static_cast<int>(jobs.size());
+}
+int AssetLoader::finishedCount() const
+{
+    return finished.load();
+}
+bool AssetLoader::done() const
+{
+    return finished.load() == static_cast<int>(jobs.size());
+}
+void AssetLoader::workerLoop(int thread)
+{
+    // jobs are claimed one at a time, the MP3s take longest and should not all queue on one thread
+    for (int i = nextJob++; i < static_cast<int>(jobs.size()); i = nextJob++)
+    {
+        AssetJob& job = jobs[i];
+        auto jobStart = chrono::steady_clock::now();
+        job.loaded = load(job);
+        job.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - jobStart).count();
+        job.thread = thread;
+        finished++; // publishes the job to the main thread
+    }
+}
+// Pre-decoded entries are taken as they are, files are decoded from memory (no copy of their bytes)
+bool AssetLoader::load(const AssetJob& job) const
+{
+    const ArchiveEntry* entry = archive.find(job.name);
+    if (!entry)
+        return false;
+    const uint8_t* data = archive.data(*entry);
+    size_t size = static_cast<size_t>(entry->size);
+    if (job.kind == ASSET_IMAGE)
+    {
+        Image& image = *static_cast<Image*>(job.target);
+        if (entry->kind != ENTRY_RGBA)
+            return entry->kind == ENTRY_FILE && image.loadFromMemory(data, size);
+        if (size != static_cast<size_t>(entry->width) * entry->height * 4)
+            return false;
+        image.create(entry->width, entry->height, data);
+        return true;
+    }
+    if (job.kind == ASSET_SOUND && entry->kind == ENTRY_PCM)
+    {
+        return static_cast<SoundBuffer*>(job.target)->loadFromSamples(reinterpret_cast<const Int16*>(data),
+                                                                      size / sizeof(Int16), entry->channels,
+                                                                      entry->sampleRate);
+    }
+    if (entry->kind != ENTRY_FILE)
+        return false;
+    if (job.kind == ASSET_FONT)
+        return static_cast<Font*>(job.target)->loadFromMemory(data, size);
+    if (job.kind == ASSET_MUSIC)
+        return static_cast<Music*>(job.target)->openFromMemory(data, size);
+    return static_cast<SoundBuffer*>(job.target)->loadFromMemory(data, size);
+}
+void AssetLoader::cancel()
+{
+    cancelled = true;
+    nextJob = jobCount(); // every later claim is past the end, the workers stop after their current job
+}
+bool AssetLoader::finish()
+{
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+    }
+    threads.clear();
+    if (cancelled)
+    {
+        printf("Loading cancelled after %d of %d assets\n", finishedCount(), jobCount());
+        return false;
+    }
+    double wall = chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
+    double serial = 0;
+    bool allLoaded = true;
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        const AssetJob& job = jobs[i];
+        printf("  %-36s %8.2f ms  (thread %d)%s\n", job.name, job.milliseconds, job.thread,
+               job.loaded ? "" : "  FAILED");
+        serial += job.milliseconds;
+        if (!job.loaded)
+        {
+            cerr << "Failed to load " << job.name << endl;
+            allLoaded = false;
+        }
+    }
+    printf("Decoded %d assets in %.2f ms on %d threads (%.2f ms one after another)\n", jobCount(), wall,
+           threadsUsed, serial);
+    return allLoaded;
+}
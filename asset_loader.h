@@ -0,0 +1,67 @@
+#pragma once
+// Startup asset loading: assets come out of the mapped archive (asset_archive.h) and whatever still
+// needs decoding is decoded on worker threads while the main thread keeps the window alive with a
+// loading screen. Only CPU side objects are built here (sf::Image, not sf::Texture), the GPU upload
+// stays on the thread that owns the GL context.
+// finish() prints how long every asset took and fails if any of them could not be loaded.
+#include <SFML/Graphics.hpp>
+#include <SFML/Audio.hpp>
+#include "asset_archive.h"
+// C++ libraries
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// Asset kinds
+const int ASSET_IMAGE = 0;
+const int ASSET_FONT = 1;
+const int ASSET_MUSIC = 2; // only opened, music streams while it plays
+const int ASSET_SOUND = 3;
+
+struct AssetJob
+{
+    const char* name;    // entry in the archive
+    int kind;
+    void* target;        // sf::Image / sf::Font / sf::Music / sf::SoundBuffer, by kind
+    bool loaded;
+    double milliseconds; // decode time
+    int thread;          // which loader thread decoded it
+};
+
+class AssetLoader
+{
+public:
+    // Fonts and music read from the archive while they are used, it has to outlive them
+    explicit AssetLoader(const AssetArchive& archive);
+    ~AssetLoader();
+    // Queue assets (before start())
+    void addImage(sf::Image& image, const char name[]);
+    void addFont(sf::Font& font, const char name[]);
+    void addMusic(sf::Music& music, const char name[]);
+    void addSound(sf::SoundBuffer& buffer, const char name[]);
+    // Start decoding on up to `threads` threads and return straight away
+    void start(int threads);
+    int jobCount() const;
+    int finishedCount() const;
+    bool done() const;
+    // Drop the assets no thread has started on (window closed while loading), finish() then only
+    // waits for the ones being decoded
+    void cancel();
+    // Wait for the threads, print the time per asset. False if any asset failed to load or was dropped
+    bool finish();
+
+private:
+    const AssetArchive& archive;
+    std::vector<AssetJob> jobs;
+    std::vector<std::thread> threads;
+    int threadsUsed = 0;
+    std::atomic<int> nextJob{0};
+    std::atomic<int> finished{0};
+    bool cancelled = false;
+    std::chrono::steady_clock::time_point startTime;
+
+    void add(void* target, int kind, const char name[]);
+    bool load(const AssetJob& job) const;
+    void workerLoop(int thread);
+};
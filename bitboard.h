@@ -0,0 +1,219 @@
+#pragma once
+// Bitboard board representation: for every entity type each row is a run of words,
+// bit c%wordBits of word c/wordBits set means that type occupies column c. Moving down/up is
+// moving the words to the next/previous row and collisions are ANDs between the words of two types.
+// Each row also keeps a byte of which types it holds, so sweeps skip empty rows and a type
+// with nothing alive costs nothing.
+//
+// Board<Rows, Cols> has its size fixed at compile time: plain arrays, the narrowest word that
+// fits a row, and loops over rows/words with constant bounds the compiler can unroll.
+// Board<DYNAMIC_SIZE, DYNAMIC_SIZE> (DynamicBoard) is sized at runtime with 64-bit words.
+// Both have the same members, so every helper below and the sweep work on either.
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// Classic board size (the one the game window shows)
+const int ROWS = 23;
+const int COLS = 15;
+// Cell types (same codes the old int grid used)
+const int CELL_EMPTY = 0;
+const int CELL_PLAYER = 1;
+const int CELL_METEOR = 2;
+const int CELL_BULLET = 3;
+const int CELL_ENEMY = 4;
+const int CELL_BOSS = 5;
+const int CELL_BOSS_BULLET = 6;
+const int CELL_TYPES = 7;
+
+const int DYNAMIC_SIZE = 0;
+
+// Narrowest unsigned word holding `Cols` bits (a 64-bit word per 64 columns past that)
+template <int Cols>
+using RowWordFor = typename std::conditional<(Cols <= 16), uint16_t,
+                   typename std::conditional<(Cols <= 32), uint32_t, uint64_t>::type>::type;
+
+template <int Rows, int Cols>
+struct Board
+{
+    typedef RowWordFor<Cols> Word;
+    static constexpr int rowCount = Rows;
+    static constexpr int colCount = Cols;
+    static constexpr int wordBits = sizeof(Word) * 8;
+    static constexpr int wordsPerRow = (Cols + wordBits - 1) / wordBits;
+    Word words[CELL_TYPES * Rows * wordsPerRow]; // [type][row][word], words of CELL_EMPTY are unused
+    uint8_t rowTypes[Rows];                      // per row: typeBit() of every type that has a cell in it
+};
+
+template <>
+struct Board<DYNAMIC_SIZE, DYNAMIC_SIZE>
+{
+    typedef uint64_t Word;
+    static constexpr int wordBits = 64;
+    int rowCount = 0;
+    int colCount = 0;
+    int wordsPerRow = 0;
+    std::vector<Word> words;
+    std::vector<uint8_t> rowTypes;
+};
+
+typedef Board<ROWS, COLS> ClassicBoard;
+typedef Board<DYNAMIC_SIZE, DYNAMIC_SIZE> DynamicBoard;
+
+inline unsigned typeBit(int type) // sets of cell types
+{
+    return 1u << type;
+}
+// Lowest set bit of a non-zero word
+inline int lowestBit(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (!(word & 1u))
+    {
+        word >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+inline int countBits(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int count = 0;
+    for (; word; word &= word - 1)
+        count++;
+    return count;
+#endif
+}
+
+// Set the size and clear everything (a fixed board can only be "resized" to its own size)
+template <int Rows, int Cols>
+inline void resizeBoard(Board<Rows, Cols>& board, int rows, int cols)
+{
+    assert(rows == Rows && cols == Cols);
+    (void)rows;
+    (void)cols;
+    for (int i = 0; i < CELL_TYPES * Rows * board.wordsPerRow; i++)
+    {
+        board.words[i] = 0;
+    }
+    for (int r = 0; r < Rows; r++)
+    {
+        board.rowTypes[r] = 0;
+    }
+}
+inline void resizeBoard(DynamicBoard& board, int rows, int cols)
+{
+    board.rowCount = rows;
+    board.colCount = cols;
+    board.wordsPerRow = (cols + DynamicBoard::wordBits - 1) / DynamicBoard::wordBits;
+    board.words.assign(static_cast<size_t>(CELL_TYPES) * rows * board.wordsPerRow, 0);
+    board.rowTypes.assign(rows, 0);
+}
+// Words of one type in one row
+template <class BoardT>
+inline typename BoardT::Word* rowWords(BoardT& board, int type, int row)
+{
+    return &board.words[(static_cast<size_t>(type) * board.rowCount + row) * board.wordsPerRow];
+}
+template <class BoardT>
+inline const typename BoardT::Word* rowWords(const BoardT& board, int type, int row)
+{
+    return &board.words[(static_cast<size_t>(type) * board.rowCount + row) * board.wordsPerRow];
+}
+// Every occupied cell of one word of a row, whatever the type
+template <class BoardT>
+inline typename BoardT::Word occupiedWord(const BoardT& board, int row, int word)
+{
+    typename BoardT::Word cells = 0;
+    for (int type = CELL_PLAYER; type < CELL_TYPES; type++)
+    {
+        cells |= rowWords(board, type, row)[word];
+    }
+    return cells;
+}
+// Bit of a column inside its word
+template <class BoardT>
+inline typename BoardT::Word colBit(const BoardT&, int col)
+{
+    return static_cast<typename BoardT::Word>(typename BoardT::Word(1) << (col % BoardT::wordBits));
+}
+template <class BoardT>
+inline bool hasCell(const BoardT& board, int type, int row, int col)
+{
+    return (rowWords(board, type, row)[col / BoardT::wordBits] & colBit(board, col)) != 0;
+}
+// Type in one cell (CELL_EMPTY if nothing is there)
+template <class BoardT>
+inline int cellAt(const BoardT& board, int row, int col)
+{
+    for (int type = CELL_PLAYER; type < CELL_TYPES; type++)
+    {
+        if ((board.rowTypes[row] & typeBit(type)) && hasCell(board, type, row, col))
+            return type;
+    }
+    return CELL_EMPTY;
+}
+template <class BoardT>
+inline void addCell(BoardT& board, int type, int row, int col)
+{
+    rowWords(board, type, row)[col / BoardT::wordBits] |= colBit(board, col);
+    board.rowTypes[row] |= typeBit(type);
+}
+// Remove one type from a whole row
+template <class BoardT>
+inline void clearRowType(BoardT& board, int type, int row)
+{
+    if (!(board.rowTypes[row] & typeBit(type)))
+        return;
+    typename BoardT::Word* words = rowWords(board, type, row);
+    for (int w = 0; w < board.wordsPerRow; w++)
+    {
+        words[w] = 0;
+    }
+    board.rowTypes[row] &= ~typeBit(type);
+}
+// Put a type in one cell, replacing whatever was there
+template <class BoardT>
+inline void setCell(BoardT& board, int row, int col, int type)
+{
+    int old = cellAt(board, row, col);
+    if (old != CELL_EMPTY)
+    {
+        typename BoardT::Word* words = rowWords(board, old, row);
+        words[col / BoardT::wordBits] &= ~colBit(board, col);
+        bool left = false;
+        for (int w = 0; w < board.wordsPerRow && !left; w++)
+        {
+            left = words[w] != 0;
+        }
+        if (!left)
+            board.rowTypes[row] &= ~typeBit(old);
+    }
+    if (type != CELL_EMPTY)
+        addCell(board, type, row, col);
+}
+// How many of one type are on the board
+template <class BoardT>
+inline int population(const BoardT& board, int type)
+{
+    int count = 0;
+    for (int r = 0; r < board.rowCount; r++)
+    {
+        if (!(board.rowTypes[r] & typeBit(type)))
+            continue;
+        const typename BoardT::Word* words = rowWords(board, type, r);
+        for (int w = 0; w < board.wordsPerRow; w++)
+        {
+            count += countBits(words[w]);
+        }
+    }
+    return count;
+}
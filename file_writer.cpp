@@ -0,0 +1,131 @@
+#include "file_writer.h"
+// C++ libraries
+#include <iostream>
+#include <cstdio>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+// namespaces
+using namespace std;
+
+bool writeFileAtomically(const string& path, const vector<uint8_t>& bytes)
+{
+    string temp = path + ".tmp";
+#if !defined(_WIN32)
+    int file = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0)
+        return false;
+    size_t written = 0;
+    while (written < bytes.size())
+    {
+        ssize_t count = ::write(file, bytes.data() + written, bytes.size() - written);
+        if (count < 0)
+            break;
+        written += static_cast<size_t>(count);
+    }
+    bool ok = written == bytes.size() && fsync(file) == 0; // on disk before it takes the old file's place
+    ok = close(file) == 0 && ok;
+    if (!ok || rename(temp.c_str(), path.c_str()) != 0)
+    {
+        unlink(temp.c_str());
+        return false;
+    }
+    // make the rename itself stick
+    size_t slash = path.find_last_of('/');
+    string directory = slash == string::npos ? "." : path.substr(0, slash + 1);
+    int folder = open(directory.c_str(), O_RDONLY);
+    if (folder >= 0)
+    {
+        fsync(folder);
+        close(folder);
+    }
+    return true;
+#else
+    HANDLE file = CreateFileA(temp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    size_t written = 0;
+    while (written < bytes.size())
+    {
+        DWORD count = 0;
+        DWORD chunk = static_cast<DWORD>(bytes.size() - written > 0x40000000 ? 0x40000000 : bytes.size() - written);
+        if (!WriteFile(file, bytes.data() + written, chunk, &count, nullptr) || count == 0)
+            break;
+        written += count;
+    }
+    bool ok = written == bytes.size() && FlushFileBuffers(file); // on disk before it takes the old file's place
+    ok = CloseHandle(file) && ok;
+    if (!ok)
+    {
+        DeleteFileA(temp.c_str());
+        return false;
+    }
+    // write-through: the move only returns once the rename is on disk too
+    if (!MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    {
+        DeleteFileA(temp.c_str());
+        return false;
+    }
+    return true;
+#endif
+}
+
+FileWriter::FileWriter()
+{
+    writer = thread(&FileWriter::writerLoop, this);
+}
+FileWriter::~FileWriter()
+{
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    writer.join(); // the loop only stops once the queue is empty
+}
+void FileWriter::write(const string& path, vector<uint8_t> bytes)
+{
+    {
+        lock_guard<std::mutex> lock(mutex);
+        bool replaced = false;
+        for (size_t i = 0; i < jobs.size() && !replaced; i++)
+        {
+            if (jobs[i].path == path)
+            {
+                jobs[i].bytes.swap(bytes);
+                replaced = true;
+            }
+        }
+        if (!replaced)
+            jobs.push_back({path, move(bytes)});
+    }
+    wake.notify_one();
+}
+void FileWriter::finish()
+{
+    unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return jobs.empty() && !writing; });
+}
+void FileWriter::writerLoop()
+{
+    unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty()) // stopping, and nothing left
+            break;
+        Job job = move(jobs.front());
+        jobs.pop_front();
+        writing = true;
+        lock.unlock(); // the game thread can queue more while this one is on its way to disk
+        if (!writeFileAtomically(job.path, job.bytes))
+            cerr << "Failed to write " << job.path << endl;
+        lock.lock();
+        writing = false;
+        if (jobs.empty())
+            idle.notify_all();
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+// Background file writes: the game thread hands over the bytes and carries on, an I/O thread writes
+// them. Every file is replaced atomically (written to <path>.tmp, synced, renamed over <path>), so a
+// crash or power cut mid-write leaves either the old file or the new one, never half of each.
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+// Write `bytes` to `path` through a synced temp file and a rename, on the calling thread
+bool writeFileAtomically(const std::string& path, const std::vector<uint8_t>& bytes);
+
+class FileWriter
+{
+public:
+    FileWriter();
+    ~FileWriter(); // writes everything still queued before returning
+    FileWriter(const FileWriter&) = delete;
+    FileWriter& operator=(const FileWriter&) = delete;
+
+    // Queue a write and return at once. A write to a path that is still queued replaces it, only the
+    // newest contents matter
+    void write(const std::string& path, std::vector<uint8_t> bytes);
+    void finish(); // wait until every queued write is on disk
+
+private:
+    struct Job
+    {
+        std::string path;
+        std::vector<uint8_t> bytes;
+    };
+    void writerLoop();
+
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake; // a job was queued (or the writer is stopping)
+    std::condition_variable idle; // the queue ran empty
+    std::deque<Job> jobs;
+    bool writing = false;         // the writer holds a job outside the lock
+    bool stopping = false;
+};
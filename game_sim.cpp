@@ -0,0 +1,851 @@
+#include "game_sim.h"
+// C++ libraries
+#include <utility>
+// namespaces
+using namespace std;
+
+// What happens when a moving entity steps into a cell, one entry per mover x occupant
+const int ACT_MOVE = 0;      // mover takes the cell (empty, or its own kind)
+const int ACT_VANISH = 1;    // mover disappears, occupant stays
+const int ACT_OVERWRITE = 2; // mover takes the cell and the occupant disappears
+const int ACT_DAMAGE = 3;    // mover disappears and the player takes a hit
+const int ACT_DESTROY = 4;   // both disappear with an explosion, maybe for points
+const int METEOR_POINTS = -1; // 1-2 random points instead of a fixed amount
+struct Interaction
+{
+    int action;
+    unsigned sound; // ACT_DAMAGE: sound when a shield absorbs it, ACT_DESTROY: sound of the explosion
+    int points;     // ACT_DESTROY: score for it (METEOR_POINTS for a random 1-2)
+    bool kill;      // ACT_DESTROY: counts towards the level's kills
+    bool effect;    // leave an explosion effect in the cell
+};
+constexpr Interaction MOVE = {ACT_MOVE, 0, 0, false, false};
+constexpr Interaction VANISH = {ACT_VANISH, 0, 0, false, false};
+constexpr Interaction OVERWRITE = {ACT_OVERWRITE, 0, 0, false, false};
+constexpr Interaction INTERACTIONS[CELL_TYPES][CELL_TYPES] = {
+    // occupant: Empty, Player, Meteor, Bullet, Enemy, Boss, Boss Bullet
+    {MOVE, MOVE, MOVE, MOVE, MOVE, MOVE, MOVE}, // Empty never moves
+    {MOVE, MOVE, MOVE, MOVE, MOVE, MOVE, MOVE}, // Player moves through handleInput
+    // Meteor
+    {MOVE, {ACT_DAMAGE, SOUND_DAMAGE, 0, false, false}, MOVE,
+     {ACT_DESTROY, SOUND_EXPLOSION, METEOR_POINTS, false, true}, VANISH, VANISH, VANISH},
+    // Bullet
+    {MOVE, VANISH, {ACT_DESTROY, SOUND_EXPLOSION, METEOR_POINTS, false, true}, MOVE,
+     {ACT_DESTROY, SOUND_EXPLOSION, 3, true, true}, {ACT_DESTROY, SOUND_EXPLOSION, 5, true, true},
+     {ACT_DESTROY, SOUND_EXPLOSION, 0, false, true}},
+    // Enemy
+    {MOVE, {ACT_DAMAGE, SOUND_EXPLOSION, 0, false, false}, VANISH,
+     {ACT_DESTROY, SOUND_EXPLOSION, 3, true, true}, MOVE, VANISH, VANISH},
+    // Boss
+    {MOVE, {ACT_DAMAGE, SOUND_EXPLOSION, 0, false, false}, OVERWRITE,
+     {ACT_DESTROY, SOUND_EXPLOSION, 5, true, true}, OVERWRITE, MOVE, OVERWRITE},
+    // Boss Bullet
+    {MOVE, {ACT_DAMAGE, SOUND_EXPLOSION, 0, false, true}, OVERWRITE, VANISH, OVERWRITE, VANISH, MOVE},
+};
+// Which way each type moves and what happens when it runs off the board
+struct Motion
+{
+    int direction;          // +1 down, -1 up, 0 does not move on its own
+    unsigned edgeDamage;    // 0: just leaves the board, else the player is hit (shield sound)
+};
+constexpr Motion MOTIONS[CELL_TYPES] = {
+    {0, 0},             // Empty
+    {0, 0},             // Player
+    {1, 0},             // Meteor
+    {-1, 0},            // Bullet
+    {1, SOUND_DAMAGE},  // Enemy: getting past the player costs a life
+    {1, SOUND_DAMAGE},  // Boss
+    {1, 0},             // Boss Bullet
+};
+// Helper functions:
+void clearHitEffects(HitEffectPool& pool)
+{
+    pool.liveCount = 0;
+    pool.freeCount = MAX_HIT_EFFECTS;
+    for (int i = 0; i < MAX_HIT_EFFECTS; i++)
+    {
+        pool.freeSlots[i] = MAX_HIT_EFFECTS - 1 - i; // slot 0 handed out first
+    }
+}
+void createExplosionEffect(HitEffectPool& pool, int row, int col)
+{
+    if (pool.freeCount == 0) // all busy
+    {
+        pool.dropped++;
+        return;
+    }
+    int slot = pool.freeSlots[--pool.freeCount];
+    pool.row[slot] = row;
+    pool.col[slot] = col;
+    pool.timer[slot] = 0;
+    pool.live[pool.liveCount++] = slot;
+}
+void ageHitEffects(HitEffectPool& pool)
+{
+    for (int i = 0; i < pool.liveCount;)
+    {
+        int slot = pool.live[i];
+        pool.timer[slot]++; // time passes
+        if (pool.timer[slot] >= HIT_EFFECT_TICKS) // visible for 0.3s, remove it
+        {
+            pool.freeSlots[pool.freeCount++] = slot;
+            pool.live[i] = pool.live[--pool.liveCount]; // the last live one takes its place, look at it next
+            continue;
+        }
+        i++;
+    }
+}
+template <class BoardT>
+void clearGrid(BoardT& board)
+{
+    size_t wordCount = static_cast<size_t>(CELL_TYPES) * board.rowCount * board.wordsPerRow;
+    for (size_t i = 0; i < wordCount; i++)
+    {
+        board.words[i] = 0;
+    }
+    for (int r = 0; r < board.rowCount; r++)
+    {
+        board.rowTypes[r] = 0;
+    }
+}
+template <class BoardT>
+void clearEntities(BoardT& board)
+{
+    for (int r = 0; r < board.rowCount; r++)
+    {
+        for (int type = CELL_METEOR; type < CELL_TYPES; type++) // everything but the player
+        {
+            clearRowType(board, type, r); // only touches types the row holds
+        }
+    }
+}
+template <class BoardT>
+void resetSpaceship(BoardT& board, int& spaceshipCol)
+{
+    spaceshipCol = board.colCount / 2;
+    clearRowType(board, CELL_PLAYER, board.rowCount - 1);
+    addCell(board, CELL_PLAYER, board.rowCount - 1, spaceshipCol);
+}
+// Move intervals: 0.7s at level 1, 0.12s faster per level
+int meteorMoveInterval(int level)
+{
+    int ticks = 70 - (level - 1) * 12;
+    if (ticks < 33)  // cannot go below 0.333s
+        ticks = 33;
+    return ticks;
+}
+int enemyMoveInterval(int level)
+{
+    return 70 - (level - 1) * 12;  // same speed logic as meteors (but no lower limit)
+}
+int bossMoveInterval(int level)
+{
+    int ticks = 80 - (level - 3) * 10;  // 0.8s at level 3, 0.1s faster per level
+    if (ticks < 50) // cannot go below 0.5s
+        ticks = 50;
+    return ticks;
+}
+// GameSim
+template <class BoardT>
+BasicGameSim<BoardT>::BasicGameSim()
+{
+    workers = nullptr;
+    gameEvents.reserve(EVENT_QUEUE_RESERVE);
+    resizeBoard(board, ROWS, COLS);
+    resizeBoard(nextBoard, ROWS, COLS);
+    lives = 3;
+    score = 0;
+    killCount = 0;
+    level = 1;
+    bossMoveCounter = 0;
+    isInvincible = false;
+    invincibilityTicks = 0;
+    for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
+    {
+        shieldPowerupRow[i] = -1;
+        shieldPowerupCol[i] = -1;
+        shieldPowerupActive[i] = false;
+        shieldPowerupDirection[i] = 0;
+    }
+    hasShield = false;
+    hitEffects.dropped = 0;
+    clearHitEffects(hitEffects);
+    // Spaceship Initialization: Set up player's spaceship at starting position
+    resetSpaceship(board, spaceshipCol);
+    moveTicks = 0;
+    bulletFireTicks = 0;
+    restartTimers();
+    setSeed(DEFAULT_SEED);
+    beginStep(0.0f);
+}
+template <class BoardT>
+void BasicGameSim<BoardT>::setSeed(uint64_t newSeed)
+{
+    seed = newSeed;
+    for (int i = 0; i < RNG_STREAMS; i++)
+    {
+        seedRandom(rng[i], seed, i);
+    }
+    // first spawns of a game
+    nextSpawnTicks = (1 + randomBelow(rng[RNG_METEOR], 3)) * TICK_RATE;
+    nextEnemySpawnTicks = (2 + randomBelow(rng[RNG_ENEMY], 4)) * TICK_RATE;
+    nextBossSpawnTicks = (8 + randomBelow(rng[RNG_BOSS], 5)) * TICK_RATE;
+    nextShieldPowerupSpawnTicks = (15 + randomBelow(rng[RNG_SHIELD], 10)) * TICK_RATE;
+}
+template <class BoardT>
+void BasicGameSim<BoardT>::setBoardSize(int rows, int cols)
+{
+    resizeBoard(board, rows, cols);
+    resizeBoard(nextBoard, rows, cols);
+    for (int i = 0; i < MAX_SHIELD_POWERUPS; i++) // may be off the new board
+    {
+        shieldPowerupActive[i] = false;
+    }
+    clearHitEffects(hitEffects);
+    resetSpaceship(board, spaceshipCol);
+}
+template <class BoardT>
+void BasicGameSim<BoardT>::newGame(int startLives, int startScore, int startLevel)
+{
+    lives = startLives;
+    score = startScore;
+    level = startLevel;
+    restartLevel();
+}
+template <class BoardT>
+void BasicGameSim<BoardT>::restartLevel()
+{
+    killCount = 0;
+    bossMoveCounter = 0;
+    isInvincible = false;
+    hasShield = false;
+    clearGrid(board);
+    for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
+    {
+        shieldPowerupActive[i] = false;
+    }
+    resetSpaceship(board, spaceshipCol);
+    restartTimers();
+}
+template <class BoardT>
+void BasicGameSim<BoardT>::restartTimers()
+{
+    meteorSpawnTicks = 0;
+    meteorMoveTicks = 0;
+    enemySpawnTicks = 0;
+    enemyMoveTicks = 0;
+    bossSpawnTicks = 0;
+    bossMoveTicks = 0;
+    bossBulletMoveTicks = 0;
+    bulletMoveTicks = 0;
+    shieldPowerupSpawnTicks = 0;
+    shieldPowerupMoveTicks = 0;
+    tickAccumulator = 0.0f;
+}
+template <class BoardT>
+void BasicGameSim<BoardT>::beginStep(float dt)
+{
+    sounds = 0;
+    for (int i = 0; i < SOUND_CUES; i++)
+    {
+        soundCounts[i] = 0;
+    }
+    transition = STATE_PLAYING;
+    stepTicks = 0;
+    tickAccumulator += dt;
+    if (tickAccumulator > MAX_CATCH_UP_TICKS * TICK_SECONDS) // long stall, drop what we can't catch up on
+        tickAccumulator = MAX_CATCH_UP_TICKS * TICK_SECONDS;
+}
+template <class BoardT>
+int BasicGameSim<BoardT>::step(const SimInput& input, float dt)
+{
+    return stepWith(
+        dt,
+        [&input](SimInput& next) {
+            next = input;
+            return true;
+        },
+        [] {});
+}
+template <class BoardT>
+int BasicGameSim<BoardT>::tick(const SimInput& input)
+{
+    sounds = 0;
+    transition = STATE_PLAYING;
+    // one tick passes for every subsystem
+    moveTicks++;
+    bulletFireTicks++;
+    meteorSpawnTicks++;
+    meteorMoveTicks++;
+    enemySpawnTicks++;
+    enemyMoveTicks++;
+    bossSpawnTicks++;
+    bossMoveTicks++;
+    bossBulletMoveTicks++;
+    bulletMoveTicks++;
+    shieldPowerupSpawnTicks++;
+    shieldPowerupMoveTicks++;
+    invincibilityTicks++;
+
+    handleInput(input);
+    spawnEntities();
+    moveShieldPowerups();
+    moveEntities();
+    dispatchEvents();
+    updateHitEffects();
+    if (isInvincible && invincibilityTicks >= INVINCIBILITY_TICKS)  // check if invincibitly over
+    {
+        isInvincible = false;
+    }
+    return transition;
+}
+template <class BoardT>
+void BasicGameSim<BoardT>::handleInput(const SimInput& input)
+{
+    // Spaceshipe Movement left right
+    if (moveTicks >= MOVE_COOLDOWN_TICKS)
+    {
+        bool moved = false;
+        if (input.left && spaceshipCol > 0)
+        {
+            spaceshipCol--;                   // Move left
+            moved = true; // trigger cooldown
+        }
+        else if (input.right && spaceshipCol < board.colCount - 1)
+        {
+            spaceshipCol++;                    // Move right
+            moved = true; // trigger cooldown
+        }
+        if (moved) // restart cooldown timer
+        {
+            clearRowType(board, CELL_PLAYER, board.rowCount - 1);           // Clear current position
+            setCell(board, board.rowCount - 1, spaceshipCol, CELL_PLAYER); // Put Spaceship there (crushes whatever was in the cell)
+            moveTicks = 0;
+        }
+    }
+    // Bullet firing
+    if (input.fire && bulletFireTicks >= FIRE_COOLDOWN_TICKS)
+    {
+        int bulletRow = board.rowCount - 2;  // Just above the spaceship
+        if (bulletRow >= 0 && cellAt(board, bulletRow, spaceshipCol) == CELL_EMPTY)
+        {
+            addCell(board, CELL_BULLET, bulletRow, spaceshipCol);
+            queueEvent(EVENT_SHOT, bulletRow, spaceshipCol, CELL_BULLET);
+        }
+        bulletFireTicks = 0;
+    }
+}
+template <class BoardT>
+void BasicGameSim<BoardT>::spawnEntities()
+{
+    // Metoer spawning
+    if (meteorSpawnTicks >= nextSpawnTicks)
+    {
+        int randomCol = randomBelow(rng[RNG_METEOR], board.colCount);  // Any random column
+        if (cellAt(board, 0, randomCol) == CELL_EMPTY) // Only spawn if that area is empty
+        {
+            addCell(board, CELL_METEOR, 0, randomCol);
+            queueEvent(EVENT_SPAWN, 0, randomCol, CELL_METEOR);
+        }
+        meteorSpawnTicks = 0;
+        nextSpawnTicks = (1 + randomBelow(rng[RNG_METEOR], 3)) * TICK_RATE;
+    }
+    // Enemy Spawining
+    if (enemySpawnTicks >= nextEnemySpawnTicks)
+    {
+        int randomCol = randomBelow(rng[RNG_ENEMY], board.colCount);  // Any random column
+        if (cellAt(board, 0, randomCol) == CELL_EMPTY) // Check empty
+        {
+            addCell(board, CELL_ENEMY, 0, randomCol);
+            queueEvent(EVENT_SPAWN, 0, randomCol, CELL_ENEMY);
+        }
+        enemySpawnTicks = 0;
+        int baseTicks = 200 - (level * 35);  // Base spawn time for each level (2s, decreases by 0.35s with level)
+        int variance = (250 - (level * 35)) / TICK_RATE;  // Random variation int he spawning (whole seconds)
+        if (baseTicks < 50) // should nowt be too fast
+            baseTicks = 50;
+        if (variance < 1) // should not be too fast
+            variance = 1;
+        nextEnemySpawnTicks = baseTicks + randomBelow(rng[RNG_ENEMY], variance) * TICK_RATE; // calculate time
+    }
+    // Boos spawning
+    if (level >= 3 && bossSpawnTicks >= nextBossSpawnTicks)
+    {
+        int randomCol = randomBelow(rng[RNG_BOSS], board.colCount);  // Any random column
+        if (cellAt(board, 0, randomCol) == CELL_EMPTY) // Check empty
+        {
+            addCell(board, CELL_BOSS, 0, randomCol);
+            queueEvent(EVENT_SPAWN, 0, randomCol, CELL_BOSS);
+        }
+        bossSpawnTicks = 0;
+        int bossBaseTicks = 1000 - ((level - 3) * 150);  // 10s, decreases by 1.5s with level
+        int bossVariance = 4;  // Random variation (seconds)
+        // same logic as enemies
+        if (bossBaseTicks < 500)
+            bossBaseTicks = 500;
+        nextBossSpawnTicks = bossBaseTicks + randomBelow(rng[RNG_BOSS], bossVariance) * TICK_RATE;
+    }
+    // Shield Powerup Spawning
+    if (level >= 3 && shieldPowerupSpawnTicks >= nextShieldPowerupSpawnTicks)
+    {
+        for (int i = 0; i < MAX_SHIELD_POWERUPS; i++) // separate array for powerups
+        {
+            if (!shieldPowerupActive[i]) // empty slot
+            {
+                int randomCol = randomBelow(rng[RNG_SHIELD], board.colCount);  // Any random column
+                shieldPowerupRow[i] = 0;        // Top row
+                shieldPowerupCol[i] = randomCol;
+                shieldPowerupActive[i] = true;  // powerup now visible
+                shieldPowerupDirection[i] = 0;  // move down
+                queueEvent(EVENT_POWERUP_SPAWN, 0, randomCol);
+                break;  // Only 1 powerup
+            }
+        }
+        shieldPowerupSpawnTicks = 0;
+        int shieldBaseTicks;
+        int shieldVariance;
+        if (level < 5) // 20-35 seconds for levels 3 and 4
+        {
+            shieldBaseTicks = 20 * TICK_RATE;
+            shieldVariance = 15;
+        }
+        else // 12-20 seconds for level 5
+        {
+            shieldBaseTicks = 12 * TICK_RATE;
+            shieldVariance = 8;
+        }
+        nextShieldPowerupSpawnTicks = shieldBaseTicks + randomBelow(rng[RNG_SHIELD], shieldVariance) * TICK_RATE; // calculate time
+    }
+}
+template <class BoardT>
+void BasicGameSim<BoardT>::moveShieldPowerups()
+{
+    // shield powerup movement
+    if (shieldPowerupMoveTicks < SHIELD_POWERUP_MOVE_TICKS)
+        return;
+    for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
+    {
+        if (shieldPowerupActive[i])
+        {
+            if (shieldPowerupRow[i] >= board.rowCount - 1) // moves below screen
+            {
+                shieldPowerupActive[i] = false;
+                continue;
+            }
+            if (hasCell(board, CELL_PLAYER, shieldPowerupRow[i], shieldPowerupCol[i])) // player claimed shield
+            {
+                queueEvent(EVENT_POWERUP_PICKUP, shieldPowerupRow[i], shieldPowerupCol[i], CELL_PLAYER);
+                shieldPowerupActive[i] = false;
+                continue;
+            }
+            shieldPowerupRow[i]++; // move down every time
+            if (hasCell(board, CELL_PLAYER, shieldPowerupRow[i], shieldPowerupCol[i])) // player claimed shield
+            {
+                queueEvent(EVENT_POWERUP_PICKUP, shieldPowerupRow[i], shieldPowerupCol[i], CELL_PLAYER);
+                shieldPowerupActive[i] = false;
+                continue;
+            }
+        }
+    }
+    shieldPowerupMoveTicks = 0;  // reset timer
+}
+template <class BoardT>
+void BasicGameSim<BoardT>::updateHitEffects()
+{
+    // hit effect management
+    ageHitEffects(hitEffects);
+}
+// Work out row `row` of the next board from the current one. Only reads `cur` and only writes
+// row `row` of `next` (its words and rowTypes byte), so rows can be resolved in any order and
+// bands of rows on different threads never touch the same memory.
+// Every cell can be reached by what stays in it, a down mover from the row above and an up
+// mover from the row below. An up mover and a down mover swapping cells meet in the up
+// mover's target. In a contested cell the head-on meeting is resolved first, then the
+// arrival from above, then the one from below, each against whatever holds the cell by then.
+// Events with side effects are appended in column order.
+template <class BoardT>
+void resolveRow(const BoardT& cur, BoardT& next, int row, unsigned moving, vector<CellEvent>& events)
+{
+    typedef typename BoardT::Word Word;
+    int lastRow = cur.rowCount - 1;
+    unsigned near = cur.rowTypes[row];
+    if (row > 0)
+        near |= cur.rowTypes[row - 1];
+    if (row < lastRow)
+        near |= cur.rowTypes[row + 1];
+    for (int type = CELL_PLAYER; type < CELL_TYPES; type++)
+    {
+        if (next.rowTypes[row] & typeBit(type)) // left over from two sweeps ago
+            clearRowType(next, type, row);
+    }
+    if (!near) // nothing can end up here
+        return;
+    unsigned rowTypes = 0;
+    for (int w = 0; w < cur.wordsPerRow; w++)
+    {
+        Word stay = 0, downHere = 0, upHere = 0, downIn = 0, upIn = 0;
+        for (int type = CELL_PLAYER; type < CELL_TYPES; type++)
+        {
+            if (!(near & typeBit(type)))
+                continue;
+            int direction = (moving & typeBit(type)) ? MOTIONS[type].direction : 0;
+            if (direction == 0)
+                stay |= rowWords(cur, type, row)[w];
+            else if (direction > 0)
+            {
+                downHere |= rowWords(cur, type, row)[w];
+                if (row > 0)
+                    downIn |= rowWords(cur, type, row - 1)[w];
+            }
+            else
+            {
+                upHere |= rowWords(cur, type, row)[w];
+                if (row < lastRow)
+                    upIn |= rowWords(cur, type, row + 1)[w];
+            }
+        }
+        Word headOn = upIn & downHere;      // met an up mover coming into this row
+        Word downArrive = downIn & ~upHere; // the rest met theirs in the row above
+        Word upArrive = upIn & ~downHere;
+        Word contested = headOn | (downArrive & (stay | upArrive)) | (upArrive & stay);
+
+        // movers leaving the board
+        Word leaving = row == lastRow ? downHere : 0;
+        if (row == 0)
+            leaving |= upHere;
+        while (leaving)
+        {
+            int c = w * BoardT::wordBits + lowestBit(leaving);
+            leaving &= leaving - 1;
+            int mover = cellAt(cur, row, c);
+            if (MOTIONS[mover].edgeDamage)
+                events.push_back({row, c, mover, OFF_BOARD});
+        }
+
+        // uncontested cells: keep what stays, land what arrives
+        for (int type = CELL_PLAYER; type < CELL_TYPES; type++)
+        {
+            if (!(near & typeBit(type)))
+                continue;
+            int direction = (moving & typeBit(type)) ? MOTIONS[type].direction : 0;
+            Word out;
+            if (direction == 0)
+                out = rowWords(cur, type, row)[w];
+            else if (direction > 0)
+                out = row > 0 ? rowWords(cur, type, row - 1)[w] & downArrive : 0;
+            else
+                out = row < lastRow ? rowWords(cur, type, row + 1)[w] & upArrive : 0;
+            out &= ~contested;
+            rowWords(next, type, row)[w] = out;
+            if (out)
+                rowTypes |= typeBit(type);
+        }
+
+        // contested cells, left to right
+        while (contested)
+        {
+            int bit = lowestBit(contested);
+            Word mask = Word(1) << bit;
+            int c = w * BoardT::wordBits + bit;
+            contested &= contested - 1;
+            int holder = (stay & mask) ? cellAt(cur, row, c) : CELL_EMPTY;
+            int arrivals[3];
+            int arrivalCount = 0;
+            if (headOn & mask)
+            {
+                holder = cellAt(cur, row, c); // the down mover that was about to leave
+                arrivals[arrivalCount++] = cellAt(cur, row + 1, c);
+            }
+            if (downArrive & mask)
+                arrivals[arrivalCount++] = cellAt(cur, row - 1, c);
+            if (upArrive & mask)
+                arrivals[arrivalCount++] = cellAt(cur, row + 1, c);
+            for (int i = 0; i < arrivalCount; i++)
+            {
+                int mover = arrivals[i];
+                if (holder == CELL_EMPTY)
+                {
+                    holder = mover;
+                    continue;
+                }
+                const Interaction& rule = INTERACTIONS[mover][holder];
+                if (rule.action == ACT_DAMAGE || rule.action == ACT_DESTROY)
+                    events.push_back({row, c, mover, holder});
+                if (rule.action == ACT_MOVE || rule.action == ACT_OVERWRITE)
+                    holder = mover;
+                else if (rule.action == ACT_DESTROY)
+                    holder = CELL_EMPTY;
+                // ACT_VANISH, ACT_DAMAGE: the holder stays
+            }
+            if (holder != CELL_EMPTY)
+            {
+                rowWords(next, holder, row)[w] |= mask;
+                rowTypes |= typeBit(holder);
+            }
+        }
+    }
+    next.rowTypes[row] = static_cast<uint8_t>(rowTypes);
+}
+template <class BoardT>
+void BasicGameSim<BoardT>::moveEntities()
+{
+    // which types are due to move this tick (speeds depend on the level)
+    unsigned moving = 0;
+    if (meteorMoveTicks >= meteorMoveInterval(level))
+    {
+        moving |= typeBit(CELL_METEOR);
+        meteorMoveTicks = 0;
+    }
+    if (enemyMoveTicks >= enemyMoveInterval(level))
+    {
+        moving |= typeBit(CELL_ENEMY);
+        enemyMoveTicks = 0;
+    }
+    if (bossMoveTicks >= bossMoveInterval(level))
+    {
+        moving |= typeBit(CELL_BOSS);
+        bossMoveTicks = 0;
+    }
+    if (bossBulletMoveTicks >= BOSS_BULLET_MOVE_TICKS) // boss bullets are very fast, regardless of level
+    {
+        moving |= typeBit(CELL_BOSS_BULLET);
+        bossBulletMoveTicks = 0;
+    }
+    if (bulletMoveTicks >= BULLET_MOVE_TICKS)
+    {
+        moving |= typeBit(CELL_BULLET);
+        bulletMoveTicks = 0;
+    }
+    if (!moving)
+        return;
+    sweepBoard(moving);
+    if (moving & typeBit(CELL_BOSS)) // a level up among the collisions clears these again
+    {
+        fireBossBullets();
+    }
+}
+template <class BoardT>
+void BasicGameSim<BoardT>::sweepBoard(unsigned moving)
+{
+    // read the current board, write the next one, then swap
+    int rows = board.rowCount;
+    int bands = 1;
+    if (workers && workers->threadCount() > 1 && static_cast<long>(rows) * board.wordsPerRow >= PARALLEL_MIN_WORDS)
+    {
+        bands = workers->threadCount() * BANDS_PER_THREAD; // a few per thread so slow bands even out
+        if (bands > rows)
+            bands = rows;
+    }
+    if (static_cast<int>(bandEvents.size()) < bands)
+        bandEvents.resize(bands);
+    // a band only reads the rows next to it on the current board, so band edges need no locking
+    auto sweepBand = [&](int band) {
+        int first = static_cast<int>(static_cast<long>(rows) * band / bands);
+        int last = static_cast<int>(static_cast<long>(rows) * (band + 1) / bands);
+        bandEvents[band].clear();
+        for (int r = first; r < last; r++)
+        {
+            resolveRow(board, nextBoard, r, moving, bandEvents[band]);
+        }
+    };
+    if (bands == 1)
+        sweepBand(0);
+    else
+        workers->run(bands, sweepBand);
+    swap(board, nextBoard);
+    // bands hold consecutive rows, so queueing them in band order keeps board order
+    for (int b = 0; b < bands; b++)
+    {
+        for (const CellEvent& event : bandEvents[b])
+        {
+            queueEvent(EVENT_COLLISION, event.row, event.col, event.mover, event.occupant);
+        }
+    }
+}
+template <class BoardT>
+void BasicGameSim<BoardT>::queueEvent(int type, int row, int col, int cell, int other, int value)
+{
+    gameEvents.push_back({type, row, col, cell, other, value});
+}
+template <class BoardT>
+void BasicGameSim<BoardT>::dispatchEvents()
+{
+    // in the order they were queued (a sweep queues top to bottom, left to right), so meteor points
+    // and level ups always come out the same
+    bool cleared = false; // a level up cleared the board, the collisions after it are gone with it
+    for (size_t i = 0; i < gameEvents.size(); i++)
+    {
+        const GameEvent& event = gameEvents[i];
+        if (cleared && event.type == EVENT_COLLISION)
+            continue;
+        publishEvent(event);
+        if (event.type == EVENT_SHOT)
+        {
+            raiseSound(SOUND_SHOOT);
+        }
+        else if (event.type == EVENT_POWERUP_PICKUP)
+        {
+            if (!hasShield)
+            {
+                hasShield = true;
+                raiseSound(SOUND_LEVEL_UP);
+            }
+        }
+        else if (event.type == EVENT_COLLISION)
+        {
+            cleared = !applyCollision(event);
+        }
+    }
+    gameEvents.clear();
+}
+template <class BoardT>
+void BasicGameSim<BoardT>::publishEvent(const GameEvent& event)
+{
+    for (size_t i = 0; i < listeners.size(); i++)
+    {
+        listeners[i](event);
+    }
+}
+template <class BoardT>
+bool BasicGameSim<BoardT>::applyCollision(const GameEvent& event)
+{
+    if (event.other == OFF_BOARD) // got past the player
+    {
+        damagePlayer(MOTIONS[event.cell].edgeDamage);
+        return true;
+    }
+    const Interaction& rule = INTERACTIONS[event.cell][event.other];
+    if (rule.effect)
+    {
+        createExplosionEffect(hitEffects, event.row, event.col);
+        publishEvent({EVENT_EXPLOSION, event.row, event.col, event.cell, event.other, 0});
+    }
+    if (rule.action == ACT_DAMAGE)
+    {
+        damagePlayer(rule.sound);
+        return true;
+    }
+    raiseSound(rule.sound);
+    if (rule.kill)
+        return !addKill(rule.points, event.row, event.col);
+    if (rule.points == METEOR_POINTS)
+    {
+        int meteorPoints = 1 + randomBelow(rng[RNG_SCORE], 2); // Random 1-2 points
+        score += meteorPoints;
+    }
+    else
+    {
+        score += rule.points;
+    }
+    return true;
+}
+template <class BoardT>
+void BasicGameSim<BoardT>::fireBossBullets()
+{
+    // Boss bullet firing logic
+    bossMoveCounter++; // boss has moved
+    int firingInterval;
+    if (level == 3)
+    {
+        firingInterval = 4; // fire bullet every 4 movements
+    }
+    else if (level == 4)
+    {
+        firingInterval = 3; // fire every 3 movements
+    }
+    else
+    {
+        firingInterval = 2; // fire every 2 movements
+    }
+    if (bossMoveCounter >= firingInterval)
+    {
+        for (int r = 0; r < board.rowCount - 1; r++)
+        {
+            if (!(board.rowTypes[r] & typeBit(CELL_BOSS)))
+                continue;
+            // create bullet just below every boss, if that cell is empty
+            typename BoardT::Word* bossBullets = rowWords(board, CELL_BOSS_BULLET, r + 1);
+            for (int w = 0; w < board.wordsPerRow; w++)
+            {
+                typename BoardT::Word fired = rowWords(board, CELL_BOSS, r)[w] & ~occupiedWord(board, r + 1, w);
+                bossBullets[w] |= fired;
+                if (fired)
+                    board.rowTypes[r + 1] |= typeBit(CELL_BOSS_BULLET);
+            }
+        }
+        bossMoveCounter = 0; // counter reset
+    }
+}
+template <class BoardT>
+void BasicGameSim<BoardT>::raiseSound(unsigned cues)
+{
+    sounds |= cues;
+    for (int i = 0; i < SOUND_CUES; i++)
+    {
+        if (cues & (1u << i))
+            soundCounts[i]++;
+    }
+}
+template <class BoardT>
+void BasicGameSim<BoardT>::damagePlayer(unsigned shieldSound)
+{
+    if (hasShield) // shield absorbs the hit
+    {
+        hasShield = false;
+        isInvincible = true;
+        invincibilityTicks = 0; // 2s invincibility
+        raiseSound(shieldSound);
+        publishEvent({EVENT_SHIELD_HIT, board.rowCount - 1, spaceshipCol, CELL_PLAYER, CELL_EMPTY, 0});
+    }
+    else if (!isInvincible)
+    {
+        lives--;
+        raiseSound(SOUND_DAMAGE);
+        publishEvent({EVENT_DAMAGE, board.rowCount - 1, spaceshipCol, CELL_PLAYER, CELL_EMPTY, lives});
+        isInvincible = true;
+        invincibilityTicks = 0;
+        if (lives <= 0) // game over
+        {
+            transition = STATE_GAME_OVER;
+        }
+    }
+}
+template <class BoardT>
+bool BasicGameSim<BoardT>::addKill(int points, int row, int col)
+{
+    score += points;
+    killCount++; // +1 kill
+    raiseSound(SOUND_EXPLOSION);
+    publishEvent({EVENT_KILL, row, col, CELL_EMPTY, CELL_EMPTY, points});
+    // check if level up
+    int killsNeeded = level * 10;
+    if (level < MAX_LEVEL && killCount >= killsNeeded)
+    {
+        level++;
+        raiseSound(SOUND_LEVEL_UP);
+        publishEvent({EVENT_LEVEL_UP, 0, 0, CELL_EMPTY, CELL_EMPTY, level});
+        killCount = 0;
+        bossMoveCounter = 0;
+        clearEntities(board);
+        resetSpaceship(board, spaceshipCol);
+        transition = STATE_LEVEL_UP;
+        return true;
+    }
+    else if (level >= MAX_LEVEL && killCount >= killsNeeded)
+    {
+        transition = STATE_VICTORY;
+    }
+    return false;
+}
+
+// The only two boards the rules are compiled for (see game_sim.h)
+template struct BasicGameSim<ClassicBoard>;
+template struct BasicGameSim<DynamicBoard>;
+template void resolveRow(const ClassicBoard&, ClassicBoard&, int, unsigned, vector<CellEvent>&);
+template void resolveRow(const DynamicBoard&, DynamicBoard&, int, unsigned, vector<CellEvent>&);
+template void clearGrid(ClassicBoard&);
+template void clearGrid(DynamicBoard&);
+template void clearEntities(ClassicBoard&);
+template void clearEntities(DynamicBoard&);
+template void resetSpaceship(ClassicBoard&, int&);
+template void resetSpaceship(DynamicBoard&, int&);
@@ -0,0 +1,255 @@
+#pragma once
+// Headless game rules: no SFML, no audio, no file I/O.
+// The SFML front end (main.cpp) feeds input in and plays sounds / draws from the state here.
+#include "bitboard.h"
+#include "random.h"
+#include "worker_pool.h"
+#include <functional>
+#include <vector>
+
+// Game States
+const int STATE_MENU = 0;
+const int STATE_PLAYING = 1;
+const int STATE_INSTRUCTIONS = 2;
+const int STATE_GAME_OVER = 3;
+const int STATE_LEVEL_UP = 4;
+const int STATE_VICTORY = 5;
+const int STATE_PAUSED = 6;
+// Game Constants
+const int MAX_LEVEL = 5;
+const int MAX_SHIELD_POWERUPS = 5;
+const int MAX_HIT_EFFECTS = 50;
+// Fixed timestep: the rules always advance in whole ticks of 1/100 s, whatever the frame rate
+const int TICK_RATE = 100;
+const float TICK_SECONDS = 1.0f / TICK_RATE;
+const int MAX_CATCH_UP_TICKS = 25;         // after a stall run at most 0.25s worth of ticks in one step
+// Cadences in ticks
+const int MOVE_COOLDOWN_TICKS = 10;        // 0.1s between spaceship moves
+const int FIRE_COOLDOWN_TICKS = 30;        // can shoot bullet only every 0.3 seconds
+const int BULLET_MOVE_TICKS = 5;           // player bullets move every 0.05s
+const int BOSS_BULLET_MOVE_TICKS = 15;     // boss bullets move every 0.15s
+const int SHIELD_POWERUP_MOVE_TICKS = 50;  // shield powerups fall every 0.5s
+const int INVINCIBILITY_TICKS = 200;       // 2s invincibility after a hit
+const int HIT_EFFECT_TICKS = 30;           // explosions stay visible for 0.3s
+// Random streams, one per subsystem so a change in one never shifts the numbers another gets
+const int RNG_METEOR = 0; // meteor spawn column and timing
+const int RNG_ENEMY = 1;
+const int RNG_BOSS = 2;
+const int RNG_SHIELD = 3;
+const int RNG_SCORE = 4;  // random meteor points
+const int RNG_STREAMS = 5;
+const uint64_t DEFAULT_SEED = 1;
+// Sweeping in parallel row bands only pays off on big boards
+const long PARALLEL_MIN_WORDS = 4096;      // rows * words per row
+const int BANDS_PER_THREAD = 4;
+// Sound cues raised during a step (bit flags), the front end decides how to play them
+const unsigned SOUND_SHOOT = 1u << 0;
+const unsigned SOUND_EXPLOSION = 1u << 1;
+const unsigned SOUND_DAMAGE = 1u << 2;
+const unsigned SOUND_LEVEL_UP = 1u << 3;
+const int SOUND_CUES = 4;
+
+// Game events: everything with a side effect (score, lives, sound, explosions) is queued while a
+// tick runs and dispatched once at its end, in the order it happened
+const int EVENT_SHOT = 0;            // the player fired a bullet at (row, col)
+const int EVENT_SPAWN = 1;           // `cell` appeared at (row, col)
+const int EVENT_POWERUP_SPAWN = 2;   // a shield powerup appeared at (row, col)
+const int EVENT_POWERUP_PICKUP = 3;  // the player touched a shield powerup at (row, col)
+const int EVENT_COLLISION = 4;       // `cell` ran into `other` at (row, col), or off the board
+// Outcomes, published while the queue is dispatched, right after the event that caused them
+const int EVENT_SHIELD_HIT = 5;      // the shield absorbed a hit
+const int EVENT_DAMAGE = 6;          // value: lives left
+const int EVENT_KILL = 7;            // value: points
+const int EVENT_LEVEL_UP = 8;        // value: the new level
+const int EVENT_EXPLOSION = 9;       // a collision left an explosion, `cell` / `other` as in the collision
+const int EVENT_TYPES = 10;
+const int EVENT_QUEUE_RESERVE = 256; // events a busy tick on the classic board stays under
+// `other` of a collision where the mover ran off the board
+const int OFF_BOARD = -1;
+
+// Player input for one step
+struct SimInput
+{
+    bool left = false;
+    bool right = false;
+    bool fire = false;
+};
+
+// Something that happened in a cell while the board was swept: `mover` ran into `occupant`
+// (or off the board). Queued as EVENT_COLLISION in board order once the next board is complete
+struct CellEvent
+{
+    int row;
+    int col;
+    int mover;
+    int occupant;
+};
+
+struct GameEvent
+{
+    int type;  // EVENT_*
+    int row;
+    int col;
+    int cell;  // CELL_* of the entity it is about
+    int other; // collisions: CELL_* it ran into, or OFF_BOARD
+    int value;
+};
+// Explosion effects. Slots come from a free list and the slots in use are kept packed in `live`,
+// so spawning and retiring are O(1) and aging / drawing only walk the live ones
+struct HitEffectPool
+{
+    int row[MAX_HIT_EFFECTS];
+    int col[MAX_HIT_EFFECTS];
+    int timer[MAX_HIT_EFFECTS];     // ticks the effect has been visible
+    int live[MAX_HIT_EFFECTS];      // slots in use, the first liveCount entries
+    int freeSlots[MAX_HIT_EFFECTS]; // stack of unused slots, the first freeCount entries
+    int liveCount;
+    int freeCount;
+    long dropped;                   // effects lost because every slot was busy
+};
+
+// Subscribers (replay tools, telemetry, AI) see every event as it is dispatched
+typedef std::function<void(const GameEvent&)> GameEventListener;
+
+// Everything the rules need while a game is running, on a fixed size board (GameSim, what the
+// game plays on) or one sized at runtime (BigGameSim, for stress runs)
+template <class BoardT>
+struct BasicGameSim
+{
+    // Grid System: one mask per row for each of Player, Meteor, Bullet, Enemy, Boss, Boss Bullet
+    BoardT board;
+    BoardT nextBoard;                // written by a sweep, then swapped with board
+    std::vector<GameEvent> gameEvents; // queued this tick, emptied by dispatchEvents()
+    std::vector<std::vector<CellEvent>> bandEvents; // per row band while sweeping
+    std::vector<GameEventListener> listeners;
+    WorkerPool* workers;             // optional, sweeps big boards in parallel row bands
+    int spaceshipCol;
+    int lives;
+    int score;
+    int killCount;
+    int level;
+    int bossMoveCounter;
+    bool isInvincible;
+    int invincibilityTicks; // ticks since invincibility started
+    // Shield Powerup System
+    int shieldPowerupRow[MAX_SHIELD_POWERUPS];
+    int shieldPowerupCol[MAX_SHIELD_POWERUPS];
+    bool shieldPowerupActive[MAX_SHIELD_POWERUPS];
+    int shieldPowerupDirection[MAX_SHIELD_POWERUPS];
+    bool hasShield;
+    // Hit Effect System
+    HitEffectPool hitEffects;
+    // Ticks since each subsystem last fired
+    int moveTicks;
+    int bulletFireTicks;
+    int meteorSpawnTicks;
+    int meteorMoveTicks;
+    int enemySpawnTicks;
+    int enemyMoveTicks;
+    int bossSpawnTicks;
+    int bossMoveTicks;
+    int bossBulletMoveTicks;
+    int bulletMoveTicks;
+    int shieldPowerupSpawnTicks;
+    int shieldPowerupMoveTicks;
+    // After how many ticks the next meteor / enemy / boss / shield powerup spawns
+    int nextSpawnTicks;
+    int nextEnemySpawnTicks;
+    int nextBossSpawnTicks;
+    int nextShieldPowerupSpawnTicks;
+    // Randomness: same seed + same inputs = same game
+    uint64_t seed;
+    Pcg32 rng[RNG_STREAMS];
+    // Frame time not yet consumed by a whole tick
+    float tickAccumulator;
+    // Output of the last step
+    unsigned sounds;  // SOUND_* flags
+    int soundCounts[SOUND_CUES]; // how often each cue was raised, one sound per request
+    int transition;   // STATE_PLAYING, or the state the game should switch to
+    int stepTicks;    // how many ticks it ran (what a replay records)
+
+    BasicGameSim();                                               // ROWS x COLS unless setBoardSize says otherwise
+    void setBoardSize(int rows, int cols);                        // clears the board
+    void setSeed(uint64_t newSeed);                               // reseeds every stream and rolls the first spawn times
+    void newGame(int startLives, int startScore, int startLevel); // fresh or loaded game
+    void restartLevel();                                          // pause menu "Restart"
+    void restartTimers();
+    // Advance the rules by dt seconds of frame time, running as many fixed ticks as fit.
+    // Returns STATE_PLAYING, STATE_LEVEL_UP, STATE_GAME_OVER or STATE_VICTORY
+    int step(const SimInput& input, float dt);
+    void beginStep(float dt); // clears the output of the last step and banks dt for ticks
+    // The loop behind step(), for steps whose input changes from tick to tick: nextInput(SimInput&)
+    // gives each tick's input (false stops the step with STATE_MENU, a replay that ran out) and
+    // afterTick() runs after every tick. Replay playback and rewind recording step through here too,
+    // so every kind of step starts from cleared outputs
+    template <class NextInput, class AfterTick>
+    int stepWith(float dt, NextInput nextInput, AfterTick afterTick);
+    // Advance the rules by exactly one tick (headless tools drive this directly)
+    int tick(const SimInput& input);
+
+    // Single pieces of a step, public so tools can drive them one by one
+    void handleInput(const SimInput& input);
+    void spawnEntities();
+    void moveShieldPowerups();
+    void moveEntities();                  // every type whose timer fired moves at once
+    void updateHitEffects();
+    // Build the next board from the current one with the given types (bit per CELL_* type) moving,
+    // swap, then queue the collisions
+    void sweepBoard(unsigned moving);
+    void fireBossBullets();
+    // Event queue
+    void queueEvent(int type, int row, int col, int cell = CELL_EMPTY, int other = CELL_EMPTY, int value = 0);
+    void dispatchEvents(); // applies and empties the queue, the last part of a tick
+    void publishEvent(const GameEvent& event); // to every listener
+    bool applyCollision(const GameEvent& event); // returns false when a level up cleared the board
+    void raiseSound(unsigned cues); // SOUND_* flags
+    // Shared collision outcomes
+    void damagePlayer(unsigned shieldSound);  // shield -> invincibility -> lose a life
+    bool addKill(int points, int row, int col); // returns true when it caused a level up (board was cleared)
+};
+
+template <class BoardT>
+template <class NextInput, class AfterTick>
+int BasicGameSim<BoardT>::stepWith(float dt, NextInput nextInput, AfterTick afterTick)
+{
+    beginStep(dt);
+    while (tickAccumulator >= TICK_SECONDS)
+    {
+        tickAccumulator -= TICK_SECONDS;
+        SimInput input;
+        if (!nextInput(input))
+            return STATE_MENU;
+        unsigned tickSounds = sounds;
+        tick(input);
+        stepTicks++;
+        sounds |= tickSounds;  // keep the sounds of earlier ticks in this step
+        afterTick();
+        if (transition != STATE_PLAYING) // level up / game over, the front end takes over
+            break;
+    }
+    return transition;
+}
+
+// Move intervals in ticks for a level
+int meteorMoveInterval(int level);
+int enemyMoveInterval(int level);
+int bossMoveInterval(int level);
+
+void clearHitEffects(HitEffectPool& pool); // every slot free, keeps the dropped count
+void createExplosionEffect(HitEffectPool& pool, int row, int col);
+void ageHitEffects(HitEffectPool& pool);   // one tick older, retires the ones past HIT_EFFECT_TICKS
+// One row of a sweep: reads only cur, writes only row `row` of next
+template <class BoardT>
+void resolveRow(const BoardT& cur, BoardT& next, int row, unsigned moving, std::vector<CellEvent>& events);
+template <class BoardT>
+void clearGrid(BoardT& board);
+template <class BoardT>
+void clearEntities(BoardT& board);
+template <class BoardT>
+void resetSpaceship(BoardT& board, int& spaceshipCol);
+
+// The templates above are compiled in game_sim.cpp for these two boards only
+typedef BasicGameSim<ClassicBoard> GameSim;
+typedef BasicGameSim<DynamicBoard> BigGameSim;
+extern template struct BasicGameSim<ClassicBoard>;
+extern template struct BasicGameSim<DynamicBoard>;
@@ -0,0 +1,118 @@
+#include "grid_renderer.h"
+// C++ libraries
+#include <iostream>
+// namespaces
+using namespace std;
+using namespace sf;
+
+// Which sprite draws which grid code (0=Empty, 1=Player, 2=Meteor, 3=Bullet, 4=Enemy, 5=Boss, 6=Boss Bullet)
+const int CELL_SPRITES[CELL_TYPES] = {-1, SPRITE_PLAYER, SPRITE_METEOR, SPRITE_BULLET, SPRITE_ENEMY, SPRITE_BOSS, SPRITE_BOSS_BULLET};
+
+bool loadAtlas(TextureAtlas& atlas, const Image& image)
+{
+    if (!atlas.texture.loadFromImage(image))
+    {
+        cerr << "Failed to upload the sprite atlas" << endl;
+        return false;
+    }
+    for (int i = 0; i < SPRITE_COUNT; i++)
+    {
+        atlas.rects[i] = IntRect(ATLAS_RECTS[i][0], ATLAS_RECTS[i][1], ATLAS_RECTS[i][2], ATLAS_RECTS[i][3]);
+    }
+    return true;
+}
+void addQuad(VertexArray& quads, const IntRect& rect, float x, float y, float width, float height)
+{
+    float u = static_cast<float>(rect.left);
+    float v = static_cast<float>(rect.top);
+    float u2 = static_cast<float>(rect.left + rect.width);
+    float v2 = static_cast<float>(rect.top + rect.height);
+    quads.append(Vertex(Vector2f(x, y), Vector2f(u, v)));
+    quads.append(Vertex(Vector2f(x + width, y), Vector2f(u2, v)));
+    quads.append(Vertex(Vector2f(x + width, y + height), Vector2f(u2, v2)));
+    quads.append(Vertex(Vector2f(x, y + height), Vector2f(u, v2)));
+}
+void batchBackground(VertexArray& quads, const TextureAtlas& atlas)
+{
+    addQuad(quads, atlas.rects[SPRITE_BACKGROUND], MARGIN, MARGIN, COLS * CELL_SIZE, ROWS * CELL_SIZE);
+}
+void batchGrid(VertexArray& quads, const TextureAtlas& atlas, const GameSim& sim, bool blinkPlayer)
+{
+    for (int type = CELL_PLAYER; type < CELL_TYPES; type++)
+    {
+        // flicker every 0.1s while invincible
+        if (type == CELL_PLAYER && blinkPlayer && sim.isInvincible && (sim.invincibilityTicks / 10) % 2 != 0)
+            continue;
+        const IntRect& rect = atlas.rects[CELL_SPRITES[type]];
+        bool thin = (type == CELL_BULLET || type == CELL_BOSS_BULLET); // bullets are thin and centered in the cell
+        for (int r = 0; r < sim.board.rowCount; r++)
+        {
+            if (!(sim.board.rowTypes[r] & typeBit(type))) // rows holding this type
+                continue;
+            const ClassicBoard::Word* words = rowWords(sim.board, type, r);
+            for (int w = 0; w < sim.board.wordsPerRow; w++)
+            {
+                for (ClassicBoard::Word cells = words[w]; cells; cells &= cells - 1) // only visit the set bits
+                {
+                    int c = w * ClassicBoard::wordBits + lowestBit(cells);
+                    float x = MARGIN + c * CELL_SIZE;
+                    float y = MARGIN + r * CELL_SIZE;
+                    if (thin)
+                        addQuad(quads, rect, x + BULLET_OFFSET_X, y, CELL_SIZE * 0.3f, CELL_SIZE * 0.8f);
+                    else
+                        addQuad(quads, rect, x, y, CELL_SIZE, CELL_SIZE);
+                }
+            }
+        }
+    }
+}
+void batchOverlays(VertexArray& quads, const TextureAtlas& atlas, const GameSim& sim)
+{
+    // Show all powerups
+    for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
+    {
+        if (sim.shieldPowerupActive[i])
+        {
+            addQuad(quads, atlas.rects[SPRITE_SHIELD_POWERUP], MARGIN + sim.shieldPowerupCol[i] * CELL_SIZE,
+                    MARGIN + sim.shieldPowerupRow[i] * CELL_SIZE, CELL_SIZE, CELL_SIZE);
+        }
+    }
+    if (sim.hasShield) // draw shield over the player
+    {
+        addQuad(quads, atlas.rects[SPRITE_SHIELD], MARGIN + sim.spaceshipCol * CELL_SIZE + SHIELD_OFFSET,
+                MARGIN + (ROWS - 1) * CELL_SIZE + SHIELD_OFFSET, CELL_SIZE * 1.3f, CELL_SIZE * 1.3f);
+    }
+    const HitEffectPool& effects = sim.hitEffects;
+    for (int i = 0; i < effects.liveCount; i++) // live ones only
+    {
+        int slot = effects.live[i];
+        addQuad(quads, atlas.rects[SPRITE_BULLET_HIT], MARGIN + effects.col[slot] * CELL_SIZE,
+                MARGIN + effects.row[slot] * CELL_SIZE, CELL_SIZE, CELL_SIZE);
+    }
+}
+void batchParticles(VertexArray& quads, const ParticleSystem& particles)
+{
+    // sized once and written in place, appending 4 vertices per particle is slow at these counts
+    quads.resize(static_cast<size_t>(particles.count) * 4);
+    const float half = PARTICLE_SIZE / 2.0f;
+    for (int i = 0; i < particles.count; i++)
+    {
+        float alpha = particles.life[i] * particles.fade[i];
+        Color color(static_cast<Uint8>(particles.r[i] * 255), static_cast<Uint8>(particles.g[i] * 255),
+                    static_cast<Uint8>(particles.b[i] * 255), static_cast<Uint8>((alpha < 1.0f ? alpha : 1.0f) * 255));
+        float x = MARGIN + particles.x[i] * CELL_SIZE;
+        float y = MARGIN + particles.y[i] * CELL_SIZE;
+        Vertex* quad = &quads[static_cast<size_t>(i) * 4];
+        quad[0] = Vertex(Vector2f(x - half, y - half), color);
+        quad[1] = Vertex(Vector2f(x + half, y - half), color);
+        quad[2] = Vertex(Vector2f(x + half, y + half), color);
+        quad[3] = Vertex(Vector2f(x - half, y + half), color);
+    }
+}
+void batchLives(VertexArray& quads, const TextureAtlas& atlas, int lives, float x, float y)
+{
+    for (int i = 0; i < lives; i++) // draw based on how many left
+    {
+        addQuad(quads, atlas.rects[SPRITE_LIFE], x + (i * 28), y, 24.0f, 24.0f); // + (i*28) so that they dont draw on top of each other
+    }
+}
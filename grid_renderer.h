@@ -0,0 +1,37 @@
+#pragma once
+// Batched playfield rendering: every sprite on the board becomes a quad in one sf::VertexArray
+// that samples from a single atlas texture, so the whole playfield is one draw call.
+#include <SFML/Graphics.hpp>
+#include "game_sim.h"
+#include "particles.h"
+// SPRITE_* ids and their rectangles, generated at build time by tools/atlas_packer
+#include "atlas_rects.h"
+
+// Layout of the playfield on screen
+const int CELL_SIZE = 40;
+const int MARGIN = 40;                                               // Margin around the grid
+const float BULLET_OFFSET_X = (CELL_SIZE - CELL_SIZE * 0.3f) / 2.0f; // Center bullets horizontally
+const float SHIELD_OFFSET = CELL_SIZE * -0.15f;                      // Center shield overlay
+const float PARTICLE_SIZE = 4.0f;                                    // Square particles, in pixels
+
+// One texture holding every sprite, plus where each sprite sits in it
+struct TextureAtlas
+{
+    sf::Texture texture;
+    sf::IntRect rects[SPRITE_COUNT];
+};
+
+// Upload the decoded atlas image (GL thread only) and set up its sprite rectangles
+bool loadAtlas(TextureAtlas& atlas, const sf::Image& image);
+// Append one textured quad covering (x, y, width, height) on screen
+void addQuad(sf::VertexArray& quads, const sf::IntRect& rect, float x, float y, float width, float height);
+// Playfield background
+void batchBackground(sf::VertexArray& quads, const TextureAtlas& atlas);
+// Every occupied grid cell (player blinks while invincible when blinkPlayer is set)
+void batchGrid(sf::VertexArray& quads, const TextureAtlas& atlas, const GameSim& sim, bool blinkPlayer);
+// Falling shield powerups, the shield around the player and explosion effects
+void batchOverlays(sf::VertexArray& quads, const TextureAtlas& atlas, const GameSim& sim);
+// Every live particle as a small untextured quad fading out with its life (draw with additive blending)
+void batchParticles(sf::VertexArray& quads, const ParticleSystem& particles);
+// Life icons in the sidebar starting at (x, y)
+void batchLives(sf::VertexArray& quads, const TextureAtlas& atlas, int lives, float x, float y);
@@ -5,310 +5,392 @@
 #include <iostream>
 #include <fstream>
 #include <cstdlib>
-#include <ctime>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include <thread>
+// Game rules (headless) and batched playfield renderer
+#include "game_sim.h"
+#include "grid_renderer.h"
+#include "render_layer.h"
+#include "replay.h"
+#include "profiler.h"
+#include "trace.h"
+#include "asset_loader.h"
+#include "sound_pool.h"
+#include "save_file.h"
+#include "file_writer.h"
+#include "snapshot.h"
+#include "rewind.h"
 // namespaces
 using namespace std;
 using namespace sf;
-// Grid Setup
-const int ROWS = 23;
-const int COLS = 15;
-const int CELL_SIZE = 40;
-const int MARGIN = 40;                                               // Margin around the grid
-const float BULLET_OFFSET_X = (CELL_SIZE - CELL_SIZE * 0.3f) / 2.0f; // Center bullets horizontally
-const float SHIELD_OFFSET = CELL_SIZE * -0.15f;                      // Center shield overlay
-// Game States
-const int STATE_MENU = 0;
-const int STATE_PLAYING = 1;
-const int STATE_INSTRUCTIONS = 2;
-const int STATE_GAME_OVER = 3;
-const int STATE_LEVEL_UP = 4;
-const int STATE_VICTORY = 5;
-const int STATE_PAUSED = 6;
+// State names for the trace, indexed by STATE_*
+const char* const STATE_NAMES[] = {"STATE_MENU", "STATE_PLAYING", "STATE_INSTRUCTIONS", "STATE_GAME_OVER",
+                                   "STATE_LEVEL_UP", "STATE_VICTORY", "STATE_PAUSED"};
 // Helper functions:
-void saveHighScoreAndGameOver(int& score, int& highScore, char saveFile[], bool& hasSavedGame, int& currentState, int& selectedMenuItem, Sound& loseSound)
+void saveHighScoreAndGameOver(int& score, int& highScore, FileWriter& fileWriter, bool& hasSavedGame, int& currentState, int& selectedMenuItem, SoundPool& soundPool, int loseSound)
 {
     if (score > highScore)
     {
         highScore = score;
     }
     
-    ofstream outputFile(saveFile);
-    if (outputFile.is_open())
-    {
-        outputFile << highScore << " 0 0 0";
-        outputFile.close();
-        hasSavedGame = false;
-    }
+    fileWriter.write(SAVE_FILE, encodeSaveRecord(makeSaveRecord(highScore, 0, 0, 0))); // no game to continue
+    hasSavedGame = false;
     
-    loseSound.play();
+    soundPool.request(loseSound);
     currentState = STATE_GAME_OVER;
     selectedMenuItem = 0;
 }
-void saveHighScoreAndVictory(int& score, int& highScore, char saveFile[], bool& hasSavedGame, int& currentState, int& selectedMenuItem, Sound& winSound)
+void saveHighScoreAndVictory(int& score, int& highScore, FileWriter& fileWriter, bool& hasSavedGame, int& currentState, int& selectedMenuItem, SoundPool& soundPool, int winSound)
 {
     if (score > highScore)
     {
         highScore = score;
     }
     
-    ofstream outputFile(saveFile);
-    if (outputFile.is_open())
-    {
-        outputFile << highScore << " 0 0 0";
-        outputFile.close();
-        hasSavedGame = false;
-    }
+    fileWriter.write(SAVE_FILE, encodeSaveRecord(makeSaveRecord(highScore, 0, 0, 0))); // no game to continue
+    hasSavedGame = false;
     
-    winSound.play();
+    soundPool.request(winSound);
     currentState = STATE_VICTORY;
     selectedMenuItem = 0;
 }
-void createExplosionEffect(int row, int col, int hitEffectRow[], int hitEffectCol[], float hitEffectTimer[], bool hitEffectActive[], int maxEffects)
+void setMenuColors(Text items[], int count, int selectedIndex)
 {
-    for (int i = 0; i < maxEffects; i++)
+    for (int i = 0; i < count; i++)
     {
-        if (!hitEffectActive[i])
-        {
-            hitEffectRow[i] = row;
-            hitEffectCol[i] = col;
-            hitEffectTimer[i] = 0.0f;
-            hitEffectActive[i] = true;
-            break;
-        }
+        items[i].setFillColor(i == selectedIndex ? Color::Yellow : Color::White);
     }
 }
-void clearGrid(int grid[][15])
+void setupSprite(Sprite& sprite, const TextureAtlas& atlas, int spriteId, float scaleX = 1.0f, float scaleY = 1.0f)
 {
-    for (int r = 0; r < ROWS; r++)
-    {
-        for (int c = 0; c < COLS; c++)
-        {
-            grid[r][c] = 0;
-        }
-    }
+    const IntRect& rect = atlas.rects[spriteId];
+    sprite.setTexture(atlas.texture);
+    sprite.setTextureRect(rect);
+    sprite.setScale(
+        (CELL_SIZE * scaleX) / rect.width,
+        (CELL_SIZE * scaleY) / rect.height);
 }
-void clearEntities(int grid[][15])
+// Fresh or loaded game, seeded with --seed if it was given, otherwise from the clock.
+// Every game is recorded from here on, and rewinds no further back than its start
+void startGame(GameSim& sim, Replay& replay, RewindBuffer& rewind, int lives, int score, int level, bool seedGiven,
+               uint64_t givenSeed)
 {
-    for (int r = 0; r < ROWS; r++)
-    {
-        for (int c = 0; c < COLS; c++)
-        {
-            if (grid[r][c] >= 2 && grid[r][c] <= 6)
-            {
-                grid[r][c] = 0;
-            }
-        }
-    }
+    uint64_t seed = givenSeed;
+    if (!seedGiven)
+        seed = static_cast<uint64_t>(chrono::system_clock::now().time_since_epoch().count());
+    sim.setSeed(seed);
+    sim.newGame(lives, score, level);
+    startRecording(replay, seed, lives, score, level);
+    clearRewind(rewind);
+    cout << "Game seed: " << seed << endl; // run with --seed to play the same spawns again
 }
-void restartAllClocks(Clock& meteorSpawn, Clock& meteorMove, Clock& enemySpawn, Clock& enemyMove, Clock& bossSpawn, Clock& bossMove, Clock& bossBulletMove, Clock& bulletMove, Clock& shieldSpawn, Clock& shieldMove)
+// Debris for explosions (much more for a boss) and a ring when the shield breaks, positions in cells
+void emitEventParticles(ParticleSystem& particles, const GameEvent& event)
 {
-    meteorSpawn.restart();
-    meteorMove.restart();
-    enemySpawn.restart();
-    enemyMove.restart();
-    bossSpawn.restart();
-    bossMove.restart();
-    bossBulletMove.restart();
-    bulletMove.restart();
-    shieldSpawn.restart();
-    shieldMove.restart();
+    float x = event.col + 0.5f;
+    float y = event.row + 0.5f;
+    if (event.type == EVENT_EXPLOSION && (event.cell == CELL_BOSS || event.other == CELL_BOSS))
+        emitBurst(particles, x, y, 900, 6.0f, 1.2f, 1.0f, 0.45f, 0.15f);
+    else if (event.type == EVENT_EXPLOSION)
+        emitBurst(particles, x, y, 160, 3.5f, 0.7f, 1.0f, 0.75f, 0.3f);
+    else if (event.type == EVENT_SHIELD_HIT)
+        emitRing(particles, x, y, 240, 0.6f, 3.0f, 0.6f, 0.4f, 0.8f, 1.0f);
 }
-void resetSpaceship(int grid[][15], int& spaceshipCol)
+// Game over, victory or save and quit: write the recording to replay-<seed>.rpl (on the I/O thread)
+void saveSessionReplay(Replay& replay, const GameSim& sim, FileWriter& fileWriter)
 {
-    grid[ROWS - 1][spaceshipCol] = 0;
-    spaceshipCol = COLS / 2;
-    grid[ROWS - 1][spaceshipCol] = 1;
+    if (replay.finished)
+        return;
+    finishRecording(replay, sim);
+    char replayFile[64];
+    sprintf(replayFile, "replay-%llu.rpl", static_cast<unsigned long long>(replay.seed));
+    fileWriter.write(replayFile, encodeReplay(replay));
+    cout << "Replay saved to " << replayFile << " (" << replay.records.size() << " bytes)" << endl;
 }
-void setMenuColors(Text items[], int count, int selectedIndex)
+// F5: the whole game, kept for F9 and written to QUICKSAVE_FILE on the I/O thread (it is the crash
+// recovery point too). Save & Quit passes the checksum of the SaveRecord it wrote, so "Load Saved
+// Game" only takes a snapshot written together with that save
+void quickSave(const GameSim& sim, SimSnapshot& quickSnapshot, bool& hasQuickSnapshot, FileWriter& fileWriter,
+               uint32_t saveChecksum = 0)
 {
-    for (int i = 0; i < count; i++)
-    {
-        items[i].setFillColor(i == selectedIndex ? Color::Yellow : Color::White);
-    }
+    captureSnapshot(sim, quickSnapshot);
+    quickSnapshot.saveChecksum = saveChecksum;
+    hasQuickSnapshot = true;
+    fileWriter.write(QUICKSAVE_FILE, encodeSnapshot(quickSnapshot));
 }
-bool loadTexture(Texture& texture, const char path[])
+// F9: back to the quicksave, from memory or else from the file. A replay can only start from a fresh
+// game, so the recording is saved as it is and nothing after the jump is recorded
+bool quickLoad(GameSim& sim, Replay& replay, SimSnapshot& quickSnapshot, bool& hasQuickSnapshot, FileWriter& fileWriter)
 {
-    if (!texture.loadFromFile(path))
+    if (!hasQuickSnapshot && !loadSnapshot(quickSnapshot, QUICKSAVE_FILE))
     {
-        cerr << "Failed to load " << path << endl;
+        cout << "No quicksave to load" << endl;
         return false;
     }
+    hasQuickSnapshot = true;
+    saveSessionReplay(replay, sim, fileWriter);
+    restoreSnapshot(sim, quickSnapshot);
     return true;
 }
-void setupSprite(Sprite& sprite, Texture& texture, float scaleX = 1.0f, float scaleY = 1.0f)
+// Window playback reached the end: say whether it ended like the recording did
+void reportPlayback(const Replay& replay, const GameSim& sim)
 {
-    sprite.setTexture(texture);
-    sprite.setScale(
-        (CELL_SIZE * scaleX) / texture.getSize().x,
-        (CELL_SIZE * scaleY) / texture.getSize().y);
+    cout << "Replay finished: score " << sim.score << ", kills " << sim.killCount << ", level " << sim.level;
+    if (!replay.finished)
+        cout << endl;
+    else if (sim.score == replay.endScore && sim.killCount == replay.endKills && sim.level == replay.endLevel)
+        cout << " (matches the recording)" << endl;
+    else
+        cout << " (recorded: score " << replay.endScore << ", kills " << replay.endKills << ", level "
+             << replay.endLevel << ")" << endl;
+}
+#if ENABLE_PROFILER
+// Spawns, hits, kills and level ups as instants in the --trace, listening to the rules' events
+void traceGameEvent(const GameEvent& event, const GameSim& sim)
+{
+    if (!traceEnabled)
+        return;
+    if (event.type == EVENT_SPAWN && event.cell == CELL_METEOR)
+        traceInstant("spawn meteor", "game", "col", event.col);
+    else if (event.type == EVENT_SPAWN && event.cell == CELL_ENEMY)
+        traceInstant("spawn enemy", "game", "col", event.col);
+    else if (event.type == EVENT_SPAWN)
+        traceInstant("spawn boss", "game", "col", event.col);
+    else if (event.type == EVENT_POWERUP_SPAWN)
+        traceInstant("spawn shield powerup", "game", "col", event.col);
+    else if (event.type == EVENT_SHIELD_HIT)
+        traceInstant("shield hit", "game");
+    else if (event.type == EVENT_DAMAGE)
+        traceInstant("damage", "game", "lives", event.value);
+    else if (event.type == EVENT_KILL)
+        traceInstant("kill", "game", "points", event.value, "kills", sim.killCount);
+    else if (event.type == EVENT_LEVEL_UP)
+        traceInstant("level up", "game", "level", event.value);
+}
+// F3 overlay in the sidebar: average / p99 / max of every phase over the last PROFILE_FRAMES frames,
+// the explosion effects dropped for lack of slots, then a histogram of the frame times (green under
+// 60 fps budget, red over)
+void updateProfilerOverlay(Text& profilerText, VertexArray& profilerBars, const GameSim& sim)
+{
+    string lines = "phase      avg    p99    max  (ms)\n";
+    for (int phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        PhaseStats stats = phaseStats(phase);
+        char line[64];
+        sprintf(line, "%-9s %6.2f %6.2f %6.2f\n", PHASE_NAMES[phase], stats.averageMs, stats.p99Ms, stats.maxMs);
+        lines += line;
+    }
+    char dropped[64];
+    sprintf(dropped, "hit fx %d/%d live, %ld dropped\n", sim.hitEffects.liveCount, MAX_HIT_EFFECTS, sim.hitEffects.dropped);
+    lines += dropped;
+    char legend[64];
+    sprintf(legend, "frame times, %.0fms buckets", HISTOGRAM_BUCKET_MS);
+    lines += legend;
+    profilerText.setString(lines);
+    int counts[HISTOGRAM_BUCKETS];
+    frameHistogram(counts);
+    int most = 1;
+    for (int b = 0; b < HISTOGRAM_BUCKETS; b++)
+    {
+        most = max(most, counts[b]);
+    }
+    const float barWidth = 22.0f;
+    const float maxHeight = 80.0f;
+    float left = profilerText.getPosition().x;
+    float bottom = profilerText.getPosition().y + profilerText.getLocalBounds().height + 20 + maxHeight;
+    profilerBars.clear();
+    for (int b = 0; b < HISTOGRAM_BUCKETS; b++)
+    {
+        float height = maxHeight * counts[b] / most;
+        float x = left + b * (barWidth + 2);
+        Color color = (b + 1) * HISTOGRAM_BUCKET_MS <= 1000.0 / 60 ? Color::Green : Color(220, 60, 60);
+        profilerBars.append(Vertex(Vector2f(x, bottom - height), color));
+        profilerBars.append(Vertex(Vector2f(x + barWidth, bottom - height), color));
+        profilerBars.append(Vertex(Vector2f(x + barWidth, bottom), color));
+        profilerBars.append(Vertex(Vector2f(x, bottom), color));
+    }
 }
+#endif
 // Main Function
-int main()
+int main(int argc, char* argv[])
 {
-    srand(static_cast<unsigned int>(time(0))); // Random Number Generator Setup
+    // Random Number Generator Setup: "--seed N" makes every game use the same seed
+    bool seedGiven = false;
+    uint64_t givenSeed = 0;
+    // "--replay file" plays a recorded session back in the window instead of starting at the menu
+    Replay replay;  // the session being recorded, or the one being played back
+    ReplayCursor replayCursor;
+    bool replaying = false;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "--seed") == 0)
+        {
+            seedGiven = true;
+            givenSeed = strtoull(argv[i + 1], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--replay") == 0)
+        {
+            if (!loadReplay(replay, argv[i + 1]))
+            {
+                cout << "Could not read replay " << argv[i + 1] << endl;
+                return 1;
+            }
+            replaying = true;
+        }
+        else if (strcmp(argv[i], "--trace") == 0) // Chrome / Perfetto trace of every frame, phase and game event
+        {
+#if ENABLE_PROFILER
+            if (!startTrace(argv[i + 1]))
+                cout << "Could not write trace " << argv[i + 1] << endl;
+#else
+            cout << "--trace needs a build with ENABLE_PROFILER on" << endl;
+#endif
+        }
+    }
     // Window Setup
     const int windowWidth = COLS * CELL_SIZE + MARGIN * 2 + 500;
     const int windowHeight = ROWS * CELL_SIZE + MARGIN * 2;
     RenderWindow window(VideoMode(windowWidth, windowHeight), "Space Shooter");
     window.setFramerateLimit(60);
-    // Save File Handling
-    int highScore = 0;
-    int savedLives = 0;
-    int savedScore = 0;
-    int savedLevel = 0;
-    bool hasSavedGame = false;
-    char saveFile[] = "save-file.txt";
-    ifstream inputFile(saveFile);
-    if (inputFile.is_open()) // Check if file exists
-    {
-        inputFile >> highScore >> savedLives >> savedScore >> savedLevel;
-        inputFile.close();
-        if (savedLevel > 0 && savedLives > 0) // Check if saved game exists
-        {
-            hasSavedGame = true;
-        }
-    }
-    else // Create new save file with default data
+    // Save File Handling: writes go to the I/O thread, a frame never waits on the disk
+    FileWriter fileWriter;
+    SaveRecord save = makeSaveRecord(0, 0, 0, 0);
+    if (!loadSaveRecord(save, SAVE_FILE))
     {
-        ofstream createFile(saveFile);
-        if (createFile.is_open())
-        {
-            createFile << "0 0 0 0";
-            createFile.close();
-        }
+        if (loadLegacySave(save, LEGACY_SAVE_FILE)) // carry the old text save over once
+            fileWriter.write(SAVE_FILE, encodeSaveRecord(save));
+        else if (ifstream(SAVE_FILE).is_open())
+            cout << SAVE_FILE << " is damaged, starting without a save" << endl;
     }
+    int highScore = save.highScore;
+    int savedLives = save.lives;
+    int savedScore = save.score;
+    int savedLevel = save.level;
+    uint32_t savedChecksum = save.checksum; // pairs the save with the snapshot Save & Quit wrote next to it
+    bool hasSavedGame = savedLives > 0 && savedLevel > 0 && savedLevel <= MAX_LEVEL; // Check if saved game exists
+    // Last quicksave (or Save & Quit), read from QUICKSAVE_FILE on first use
+    SimSnapshot quickSnapshot;
+    bool hasQuickSnapshot = false;
+    // The last REWIND_SECONDS of play, scrubbed back through while R is held
+    RewindBuffer rewind;
+    initRewind(rewind);
+    float rewindCredit = 0; // ticks owed to the rewind, it goes back whole ticks only
     // Game Variables
     int currentState = STATE_MENU;
     int selectedMenuItem = 0;
-    int lives = 3;
-    int score = 0;
-    int killCount = 0;
-    int level = 1;
-    const int MAX_LEVEL = 5;
-    bool isInvincible = false;
-    Clock invincibilityTimer;
-    const float INVINCIBILITY_DURATION = 2.0f;
     Clock levelUpTimer;
     bool levelUpBlinkState = true;
     Clock levelUpBlinkClock;
-    int bossMoveCounter = 0;
-    // Grid System: 0=Empty, 1=Player, 2=Meteor, 3=Bullet, 4=Enemy, 5=Boss, 6=Boss Bullet
-    int grid[ROWS][COLS] = {0};
-    // Shield Powerup System
-    const int MAX_SHIELD_POWERUPS = 5;
-    int shieldPowerupRow[MAX_SHIELD_POWERUPS] = {-1, -1, -1, -1, -1};
-    int shieldPowerupCol[MAX_SHIELD_POWERUPS] = {-1, -1, -1, -1, -1};
-    bool shieldPowerupActive[MAX_SHIELD_POWERUPS] = {false, false, false, false, false};
-    int shieldPowerupDirection[MAX_SHIELD_POWERUPS] = {0, 0, 0, 0, 0};
-    bool hasShield = false;
-    // Hit Effect System
-    const int MAX_HIT_EFFECTS = 50;
-    int hitEffectRow[MAX_HIT_EFFECTS] = {0};
-    int hitEffectCol[MAX_HIT_EFFECTS] = {0};
-    float hitEffectTimer[MAX_HIT_EFFECTS] = {0.0f};
-    bool hitEffectActive[MAX_HIT_EFFECTS] = {false};
-    const float HIT_EFFECT_DURATION = 0.3f;
-    // Spaceship Initialization: Set up player's spaceship at starting position
-    int spaceshipCol = COLS / 2;
-    grid[ROWS - 1][spaceshipCol] = 1;
-    // Textures and Sprites Setup
-    Texture spaceshipTexture;
-    if (!loadTexture(spaceshipTexture, "assets/images/player.png")) return -1;
-    Sprite spaceship;
-    setupSprite(spaceship, spaceshipTexture);
-    Texture lifeTexture;
-    if (!loadTexture(lifeTexture, "assets/images/life.png")) return -1;
-    Sprite lifeIcon;
-    lifeIcon.setTexture(lifeTexture);
-    lifeIcon.setScale(24.0f / lifeTexture.getSize().x, 24.0f / lifeTexture.getSize().y);
-    Texture shieldTexture, shieldPowerUpTexture;
-    if (!loadTexture(shieldTexture, "assets/images/shield.png")) return -1;
-    if (!loadTexture(shieldPowerUpTexture, "assets/images/shield-powerup.png")) return -1;
-    Sprite shieldIcon, shieldPowerUp;
-    setupSprite(shieldPowerUp, shieldPowerUpTexture);
-    setupSprite(shieldIcon, shieldTexture, 1.3f, 1.3f);
-    Texture bgTexture;
-    if (!loadTexture(bgTexture, "assets/images/backgroundColor.png")) return -1;
-    Sprite background;
-    background.setTexture(bgTexture);
-    background.setScale(
-        static_cast<float>(COLS * CELL_SIZE) / bgTexture.getSize().x,
-        static_cast<float>(ROWS * CELL_SIZE) / bgTexture.getSize().y);
-    background.setPosition(MARGIN, MARGIN);
+    // Grid, player, enemies, powerups and effects all live in the simulation
+    GameSim sim;
+    // Asset Loading: everything comes from one mapped archive, whatever needs decoding is decoded
+    // on worker threads while a loading bar is drawn
+    AssetArchive archive;
+    if (!archive.open(ASSET_ARCHIVE_FILE))
+        return -1;
+    Image atlasImage;
+    Font font;
+    Music bgMusic;
+    SoundBuffer shootBuffer, explosionBuffer, damageBuffer, levelUpBuffer;
+    SoundBuffer menuClickBuffer, menuNavBuffer, winBuffer, loseBuffer;
+    AssetLoader loader(archive);
+    loader.addImage(atlasImage, ATLAS_FILE);
+    loader.addFont(font, "assets/fonts/font.ttf");
+    loader.addMusic(bgMusic, "assets/sounds/bg-music.mp3");
+    loader.addSound(shootBuffer, "assets/sounds/shoot.wav");
+    loader.addSound(explosionBuffer, "assets/sounds/explosion.wav");
+    loader.addSound(damageBuffer, "assets/sounds/damage.mp3");
+    loader.addSound(levelUpBuffer, "assets/sounds/level-up.mp3");
+    loader.addSound(menuClickBuffer, "assets/sounds/menu-click.mp3");
+    loader.addSound(menuNavBuffer, "assets/sounds/menu-navigate.wav");
+    loader.addSound(winBuffer, "assets/sounds/win.wav");
+    loader.addSound(loseBuffer, "assets/sounds/lose.wav");
+    loader.start(static_cast<int>(thread::hardware_concurrency()));
+    // Loading Screen: no font yet, just a progress bar
+    RectangleShape loadingFrame(Vector2f(400, 20));
+    loadingFrame.setFillColor(Color::Transparent);
+    loadingFrame.setOutlineThickness(2);
+    loadingFrame.setOutlineColor(Color::White);
+    loadingFrame.setPosition(windowWidth / 2 - 200, windowHeight / 2 - 10);
+    RectangleShape loadingBar;
+    loadingBar.setFillColor(Color::Yellow);
+    loadingBar.setPosition(windowWidth / 2 - 200, windowHeight / 2 - 10);
+    while (!loader.done())
+    {
+        Event event;
+        while (window.pollEvent(event))
+        {
+            if (event.type == Event::Closed)
+                window.close();
+        }
+        if (!window.isOpen())
+            break;
+        loadingBar.setSize(Vector2f(400.0f * loader.finishedCount() / loader.jobCount(), 20));
+        window.clear(Color(40, 40, 40));
+        window.draw(loadingBar);
+        window.draw(loadingFrame);
+        window.display();
+    }
+    if (!window.isOpen()) // closed while loading: don't decode the rest
+    {
+        loader.cancel();
+        loader.finish();
+        return 0;
+    }
+    if (!loader.finish()) // a missing asset is still fatal
+        return -1;
+    // Textures and Sprites Setup: every image comes from one atlas packed at build time
+    TextureAtlas atlas;
+    Clock uploadClock;
+    if (!loadAtlas(atlas, atlasImage)) return -1; // GPU upload, on this thread
+    cout << "Atlas upload: " << uploadClock.getElapsedTime().asMicroseconds() / 1000.0f << " ms" << endl;
+    Sprite spaceship, meteor, enemy, bossEnemy, bullet, bossBullet, shieldPowerUp;
+    setupSprite(spaceship, atlas, SPRITE_PLAYER);
+    setupSprite(meteor, atlas, SPRITE_METEOR);
+    setupSprite(enemy, atlas, SPRITE_ENEMY);
+    setupSprite(bossEnemy, atlas, SPRITE_BOSS);
+    setupSprite(bullet, atlas, SPRITE_BULLET, 0.3f, 0.8f);
+    setupSprite(bossBullet, atlas, SPRITE_BOSS_BULLET, 0.3f, 0.8f);
+    setupSprite(shieldPowerUp, atlas, SPRITE_SHIELD_POWERUP);
+    Sprite lifeIcon(atlas.texture, atlas.rects[SPRITE_LIFE]);
+    lifeIcon.setScale(24.0f / atlas.rects[SPRITE_LIFE].width, 24.0f / atlas.rects[SPRITE_LIFE].height);
+    Sprite menuBackground(atlas.texture, atlas.rects[SPRITE_MENU_BACKGROUND]);
+    menuBackground.setScale(
+        static_cast<float>(windowWidth) / atlas.rects[SPRITE_MENU_BACKGROUND].width,
+        static_cast<float>(windowHeight) / atlas.rects[SPRITE_MENU_BACKGROUND].height);
+    menuBackground.setPosition(0, 0);
     RectangleShape gameBox(Vector2f(COLS * CELL_SIZE, ROWS * CELL_SIZE));
     gameBox.setFillColor(Color::Transparent);
     gameBox.setOutlineThickness(5);
     gameBox.setOutlineColor(Color::Black);
     gameBox.setPosition(MARGIN, MARGIN);
-    Texture meteorTexture;
-    if (!loadTexture(meteorTexture, "assets/images/meteorSmall.png")) return -1;
-    Sprite meteor;
-    setupSprite(meteor, meteorTexture);
-    Texture enemyTexture, bossEnemyTexture;
-    if (!loadTexture(enemyTexture, "assets/images/enemyUFO.png")) return -1;
-    if (!loadTexture(bossEnemyTexture, "assets/images/enemyShip.png")) return -1;
-    Sprite enemy, bossEnemy;
-    setupSprite(enemy, enemyTexture);
-    setupSprite(bossEnemy, bossEnemyTexture);
-    Texture bulletTexture, bulletHitTexture, bossBulletTexture, bossBulletHitTexture;
-    if (!loadTexture(bulletTexture, "assets/images/laserRed.png")) return -1;
-    if (!loadTexture(bulletHitTexture, "assets/images/laserRedShot.png")) return -1;
-    if (!loadTexture(bossBulletTexture, "assets/images/laserGreen.png")) return -1;
-    if (!loadTexture(bossBulletHitTexture, "assets/images/laserGreenShot.png")) return -1;
-    Sprite bullet, bulletHit, bossBullet, bossBulletHit;
-    setupSprite(bullet, bulletTexture, 0.3f, 0.8f);
-    setupSprite(bulletHit, bulletHitTexture);
-    setupSprite(bossBullet, bossBulletTexture, 0.3f, 0.8f);
-    setupSprite(bossBulletHit, bossBulletHitTexture);
-    Texture menuBgTexture;
-    if (!loadTexture(menuBgTexture, "assets/images/starBackground.png")) return -1;
-    Sprite menuBackground;
-    menuBackground.setTexture(menuBgTexture);
-    menuBackground.setScale(
-        static_cast<float>(windowWidth) / menuBgTexture.getSize().x,
-        static_cast<float>(windowHeight) / menuBgTexture.getSize().y);
-    menuBackground.setPosition(0, 0);
-    // Font Setup for text
-    Font font;
-    if (!font.loadFromFile("assets/fonts/font.ttf"))
-    {
-        cerr << "Failed to load font" << endl;
-        return -1;
-    }
+    VertexArray playfield(Quads); // rebuilt every frame, drawn with a single call
+    // Explosion particles, spawned from the rules' events and drawn with one more call over the playfield
+    ParticleSystem particles;
+    initParticles(particles, static_cast<uint64_t>(chrono::steady_clock::now().time_since_epoch().count()));
+    VertexArray particleQuads(Quads);
+    sim.listeners.push_back([&particles](const GameEvent& event) { emitEventParticles(particles, event); });
+#if ENABLE_PROFILER
+    sim.listeners.push_back([&sim](const GameEvent& event) { traceGameEvent(event, sim); });
+#endif
     // Music and Sound Effects Setup
-    Music bgMusic;
-    if (!bgMusic.openFromFile("assets/sounds/bg-music.mp3"))
-    {
-        cerr << "Failed to load background music" << endl;
-        return -1;
-    }
     bgMusic.setLoop(true);  // Music never ends
     bgMusic.setVolume(30);  // low volume
     bgMusic.play();         // start playing as game starts
-    SoundBuffer shootBuffer, explosionBuffer, damageBuffer, levelUpBuffer;
-    SoundBuffer menuClickBuffer, menuNavBuffer, winBuffer, loseBuffer;
-    if (!shootBuffer.loadFromFile("assets/sounds/shoot.wav") ||
-        !explosionBuffer.loadFromFile("assets/sounds/explosion.wav") ||
-        !damageBuffer.loadFromFile("assets/sounds/damage.mp3") ||
-        !levelUpBuffer.loadFromFile("assets/sounds/level-up.mp3") ||
-        !menuClickBuffer.loadFromFile("assets/sounds/menu-click.mp3") ||
-        !menuNavBuffer.loadFromFile("assets/sounds/menu-navigate.wav") ||
-        !winBuffer.loadFromFile("assets/sounds/win.wav") ||
-        !loseBuffer.loadFromFile("assets/sounds/lose.wav"))
-    {
-        cerr << "Failed to load sound files" << endl;
-        return -1;
-    }
-    Sound shootSound, explosionSound, damageSound, levelUpSound;
-    Sound menuClickSound, menuNavSound, winSound, loseSound;
-    shootSound.setBuffer(shootBuffer);
-    explosionSound.setBuffer(explosionBuffer);
-    damageSound.setBuffer(damageBuffer);
-    levelUpSound.setBuffer(levelUpBuffer);
-    menuClickSound.setBuffer(menuClickBuffer);
-    menuNavSound.setBuffer(menuNavBuffer);
-    winSound.setBuffer(winBuffer);
-    loseSound.setBuffer(loseBuffer);
+    // Effects share the voices of the pool: (buffer, priority, most voices at once)
+    SoundPool soundPool;
+    int shootSound = soundPool.addEffect(shootBuffer, 1, 3);
+    int explosionSound = soundPool.addEffect(explosionBuffer, 2, 4);
+    int damageSound = soundPool.addEffect(damageBuffer, 3, 2);
+    int levelUpSound = soundPool.addEffect(levelUpBuffer, 3, 1);
+    int menuClickSound = soundPool.addEffect(menuClickBuffer, 2, 1);
+    int menuNavSound = soundPool.addEffect(menuNavBuffer, 2, 1);
+    int winSound = soundPool.addEffect(winBuffer, 3, 1);
+    int loseSound = soundPool.addEffect(loseBuffer, 3, 1);
     // Text Setup throughout the game
     Text menuTitle("SPACE SHOOTER", font, 40);
     menuTitle.setFillColor(Color::Yellow); 
@@ -348,6 +430,15 @@ int main()
     Text highScoreText("High Score: 0", font, 20);
     highScoreText.setFillColor(Color::Yellow);
     highScoreText.setPosition(MARGIN + COLS * CELL_SIZE + 20, MARGIN + 330);
+#if ENABLE_PROFILER
+    // Profiler overlay (F3), below the high score
+    bool showProfiler = false;
+    int profilerRefresh = 0; // frames until the overlay text is rebuilt
+    Text profilerText("", font, 14);
+    profilerText.setFillColor(Color(200, 200, 200));
+    profilerText.setPosition(MARGIN + COLS * CELL_SIZE + 20, MARGIN + 380);
+    VertexArray profilerBars(Quads);
+#endif
     // Game Over Screen
     Text gameOverTitle("GAME OVER", font, 40);
     gameOverTitle.setFillColor(Color::Red);
@@ -421,7 +512,7 @@ int main()
     Text shootText("Shoot: SPACEBAR", font, 18);
     shootText.setFillColor(Color::White);
     shootText.setPosition(50, 170);
-    Text pauseText("Pause: P", font, 18);
+    Text pauseText("Pause: P    Rewind: hold R    Quicksave: F5    Quickload: F9", font, 18);
     pauseText.setFillColor(Color::White);
     pauseText.setPosition(50, 200);
     Text entitiesTitle("ENTITIES", font, 24);
@@ -479,46 +570,68 @@ int main()
     Text instructionsBack("Press ESC or BACKSPACE to return to menu", font, 18);
     instructionsBack.setFillColor(Color(150, 150, 150));
     instructionsBack.setPosition(windowWidth / 2 - instructionsBack.getLocalBounds().width / 2.0f, windowHeight - 80);
-    // All the clocks and cooldowns controlling the time of events in the game
-    // Movement Delay to avoid fast movement when key is held
-    Clock moveClock;
-    Time moveCooldown = milliseconds(100);
-    // After what time will a new meteor spawn
-    Clock meteorSpawnClock;
-    Clock meteorMoveClock;
-    float nextSpawnTime = 1.0f + (rand() % 3);
-    // After what time will a new enemy spawn
-    Clock enemySpawnClock;
-    Clock enemyMoveClock;
-    float nextEnemySpawnTime = 2.0f + (rand() % 4);
-    // After what time will a new boss spawn (level 3+)
-    Clock bossSpawnClock;
-    Clock bossMoveClock;
-    Clock bossBulletMoveClock;
-    float nextBossSpawnTime = 8.0f + (rand() % 5);
-    // After what time will a new shield powerup spawn (level 3+)
-    Clock shieldPowerupSpawnClock;
-    Clock shieldPowerupMoveClock;
-    float nextShieldPowerupSpawnTime = 15.0f + (rand() % 10);
-    // Bullet firing delay and bullet speed
-    Clock bulletMoveClock;
-    Clock bulletFireClock;
-    Time bulletFireCooldown = milliseconds(300);
-    // How long to show explosion effects
-    Clock hitEffectClock;
+    // Cached layers: the static part of the current screen (whole window) and the sidebar text while
+    // playing (transparent, so particles that drift under it still show like they used to)
+    const Color screenColor(40, 40, 40); // Dark Gray Backfground
+    const int hudX = MARGIN + COLS * CELL_SIZE + 20;
+    RenderLayer screenLayer;
+    RenderLayer hudLayer;
+    if (!createLayer(screenLayer, 0, 0, windowWidth, windowHeight) ||
+        !createLayer(hudLayer, hudX, MARGIN, windowWidth - hudX, 380)) // title down to the high score
+    {
+        cout << "Failed to create the render layers" << endl;
+        return -1;
+    }
+    VertexArray layerQuads(Quads); // atlas quads drawn into a layer
+    // Frame time fed to the simulation
+    Clock frameClock;
     // same delay as movement for menu navigation to avoid fast input
     Clock menuClock;
     Time menuCooldown = milliseconds(200);
+    int tracedState = STATE_MENU; // last state the trace has seen
+    // Replay playback skips the menu
+    if (replaying)
+    {
+        bgMusic.stop();
+        currentState = STATE_PLAYING;
+        startPlayback(sim, replay, replayCursor);
+    }
     // The Game Statrs from here
     while (window.isOpen())
     {
+        PROFILE_END_FRAME();
         // Check if the user closes the window or not
-        Event event;
-        while (window.pollEvent(event))
         {
-            if (event.type == Event::Closed)
-                window.close();
+            PROFILE_SCOPE(PHASE_INPUT);
+            Event event;
+            while (window.pollEvent(event))
+            {
+                if (event.type == Event::Closed)
+                    window.close();
+                if (event.type == Event::KeyPressed && currentState == STATE_PLAYING && !replaying)
+                {
+                    if (event.key.code == Keyboard::F5)
+                    {
+                        quickSave(sim, quickSnapshot, hasQuickSnapshot, fileWriter);
+                        cout << "Quicksaved" << endl;
+                    }
+                    else if (event.key.code == Keyboard::F9 &&
+                             quickLoad(sim, replay, quickSnapshot, hasQuickSnapshot, fileWriter))
+                    {
+                        clearParticles(particles);
+                        clearRewind(rewind);
+                    }
+                }
+#if ENABLE_PROFILER
+                if (event.type == Event::KeyPressed && event.key.code == Keyboard::F3) // profiler overlay on/off
+                {
+                    showProfiler = !showProfiler;
+                    profilerRefresh = 0;
+                }
+#endif
+            }
         }
+        float frameTime = frameClock.restart().asSeconds();
         // C++ Logic for each Game Screen
         // Menu Screen
         if (currentState == STATE_MENU)
@@ -529,38 +642,24 @@ int main()
                 if (Keyboard::isKeyPressed(Keyboard::Up) || Keyboard::isKeyPressed(Keyboard::W))
                 {
                     selectedMenuItem = (selectedMenuItem - 1 + 4) % 4; // (+4 so that selected never becomes negative)
-                    menuNavSound.play();
+                    soundPool.request(menuNavSound);
                     menuAction = true;
                 }
                 else if (Keyboard::isKeyPressed(Keyboard::Down) || Keyboard::isKeyPressed(Keyboard::S))
                 {
                     selectedMenuItem = (selectedMenuItem + 1) % 4;
-                    menuNavSound.play();
+                    soundPool.request(menuNavSound);
                     menuAction = true;
                 }
                 else if (Keyboard::isKeyPressed(Keyboard::Enter))
                 {
-                    menuClickSound.play();
+                    soundPool.request(menuClickSound);
                     if (selectedMenuItem == 0) // (Start New Game)
                     {
                         bgMusic.stop();
                         currentState = STATE_PLAYING;
                         // Game Will start fresh
-                        lives = 3;
-                        score = 0;
-                        killCount = 0;
-                        level = 1;
-                        bossMoveCounter = 0;
-                        hasShield = false;
-                        clearGrid(grid);
-                        for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
-                        {
-                            shieldPowerupActive[i] = false;
-                        }
-                        resetSpaceship(grid, spaceshipCol);
-                        restartAllClocks(meteorSpawnClock, meteorMoveClock, enemySpawnClock, enemyMoveClock,
-                                        bossSpawnClock, bossMoveClock, bossBulletMoveClock, bulletMoveClock,
-                                        shieldPowerupSpawnClock, shieldPowerupMoveClock);
+                        startGame(sim, replay, rewind, 3, 0, 1, seedGiven, givenSeed);
                     }
                     else if (selectedMenuItem == 1) // (Load Saved Game)
                     {
@@ -568,22 +667,22 @@ int main()
                         {
                             bgMusic.stop();
                             currentState = STATE_PLAYING;
-                            // Game will start with saved lives, score, and level
-                            lives = savedLives;
-                            score = savedScore;
-                            killCount = 0;
-                            level = savedLevel;
-                            bossMoveCounter = 0;
-                            hasShield = false;
-                            clearGrid(grid);
-                            for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
+                            // The whole game Save & Quit left when its snapshot is still there (and not
+                            // since replaced by a quicksave), otherwise a new one with the saved lives,
+                            // score, and level
+                            if ((hasQuickSnapshot || loadSnapshot(quickSnapshot, QUICKSAVE_FILE)) &&
+                                quickSnapshot.saveChecksum != 0 && quickSnapshot.saveChecksum == savedChecksum)
                             {
-                                shieldPowerupActive[i] = false;
+                                hasQuickSnapshot = true;
+                                restoreSnapshot(sim, quickSnapshot);
+                                clearRewind(rewind);
+                                replay = Replay();
+                                replay.finished = true; // not from a fresh game, so not recorded
+                            }
+                            else
+                            {
+                                startGame(sim, replay, rewind, savedLives, savedScore, savedLevel, seedGiven, givenSeed);
                             }
-                            resetSpaceship(grid, spaceshipCol);
-                            restartAllClocks(meteorSpawnClock, meteorMoveClock, enemySpawnClock, enemyMoveClock,
-                                            bossSpawnClock, bossMoveClock, bossBulletMoveClock, bulletMoveClock,
-                                            shieldPowerupSpawnClock, shieldPowerupMoveClock);
                         }
                         else
                         {
@@ -618,37 +717,22 @@ int main()
                 if (Keyboard::isKeyPressed(Keyboard::Up) || Keyboard::isKeyPressed(Keyboard::W))
                 {
                     selectedMenuItem = (selectedMenuItem - 1 + 2) % 2;
-                    menuNavSound.play();
+                    soundPool.request(menuNavSound);
                     menuAction = true;
                 }
                 else if (Keyboard::isKeyPressed(Keyboard::Down) || Keyboard::isKeyPressed(Keyboard::S))
                 {
                     selectedMenuItem = (selectedMenuItem + 1) % 2;
-                    menuNavSound.play();
+                    soundPool.request(menuNavSound);
                     menuAction = true;
                 }
                 else if (Keyboard::isKeyPressed(Keyboard::Enter))
                 {
-                    menuClickSound.play();
+                    soundPool.request(menuClickSound);
                     if (selectedMenuItem == 0) // (Restart Game)
                     {
                         currentState = STATE_PLAYING;
-                        lives = 3;
-                        score = 0;
-                        killCount = 0;
-                        level = 1;
-                        bossMoveCounter = 0;
-                        isInvincible = false;
-                        hasShield = false;
-                        clearGrid(grid);
-                        for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
-                        {
-                            shieldPowerupActive[i] = false;
-                        }
-                        resetSpaceship(grid, spaceshipCol);
-                        restartAllClocks(meteorSpawnClock, meteorMoveClock, enemySpawnClock, enemyMoveClock,
-                                        bossSpawnClock, bossMoveClock, bossBulletMoveClock, bulletMoveClock,
-                                        shieldPowerupSpawnClock, shieldPowerupMoveClock);
+                        startGame(sim, replay, rewind, 3, 0, 1, seedGiven, givenSeed);
                     }
                     else if (selectedMenuItem == 1) // (Return to Main Menu)
                     {
@@ -675,7 +759,7 @@ int main()
             {
                 if (Keyboard::isKeyPressed(Keyboard::Escape) || Keyboard::isKeyPressed(Keyboard::BackSpace))
                 {
-                    menuClickSound.play();
+                    soundPool.request(menuClickSound);
                     currentState = STATE_MENU;
                     selectedMenuItem = 0;
                     menuClock.restart();
@@ -685,621 +769,97 @@ int main()
         // Playing Screen
         else if (currentState == STATE_PLAYING)
         {
-            if (menuClock.getElapsedTime() >= menuCooldown) // Constantly check for pause input
+            if (menuClock.getElapsedTime() >= menuCooldown && !replaying) // Constantly check for pause input
             {
                 if (Keyboard::isKeyPressed(Keyboard::P))
                 {
                     currentState = STATE_PAUSED;
                     selectedMenuItem = 0;
                     menuClock.restart();
+                    recordCommand(replay, REPLAY_PAUSE);
                 }
             }
-            // Spaceshipe Movement left right
-            if (moveClock.getElapsedTime() >= moveCooldown)
+            int nextState;
+            if (replaying) // the recorded inputs drive the rules instead of the keyboard
             {
-                bool moved = false;
-                if ((Keyboard::isKeyPressed(Keyboard::Left) || Keyboard::isKeyPressed(Keyboard::A)) && spaceshipCol > 0)
-                {
-                    grid[ROWS - 1][spaceshipCol] = 0; // Clear current position
-                    spaceshipCol--;                   // Move left
-                    grid[ROWS - 1][spaceshipCol] = 1; // Put Spaceship there
-                    moved = true; // trigger cooldown
-                }
-                else if ((Keyboard::isKeyPressed(Keyboard::Right) || Keyboard::isKeyPressed(Keyboard::D)) && spaceshipCol < COLS - 1)
-                {
-                    grid[ROWS - 1][spaceshipCol] = 0; // Clear current position
-                    spaceshipCol++;                    // Move right
-                    grid[ROWS - 1][spaceshipCol] = 1; // Put Spaceship there
-                    moved = true; // trigger cooldown
-                }
-                if (moved) // restart cooldown timer
-                {
-                    moveClock.restart();
-                }
+                PROFILE_SCOPE(PHASE_SIM);
+                nextState = stepReplay(sim, replay, replayCursor, frameTime);
             }
-            // Bullet firing
-            if (Keyboard::isKeyPressed(Keyboard::Space) && bulletFireClock.getElapsedTime() >= bulletFireCooldown)
+            else if (Keyboard::isKeyPressed(Keyboard::R)) // rewind instead of playing, REWIND_SPEED times as fast
             {
-                int bulletRow = ROWS - 2;  // Just above the spaceship
-                if (bulletRow >= 0 && grid[bulletRow][spaceshipCol] == 0)
+                sim.beginStep(0.0f); // no sounds or transitions while rewinding, even on frames that go nowhere
+                rewindCredit += frameTime * REWIND_SPEED * TICK_RATE;
+                int ticks = static_cast<int>(rewindCredit);
+                rewindCredit -= ticks;
+                if (ticks > 0 && rewind.ticks > 1)
                 {
-                    grid[bulletRow][spaceshipCol] = 3;
-                    shootSound.play();
+                    saveSessionReplay(replay, sim, fileWriter); // a replay can't go back, it ends here
+                    PROFILE_SCOPE(PHASE_SIM);
+                    rewindTicks(rewind, sim, ticks);
+                    clearParticles(particles);
                 }
-                bulletFireCooldown = milliseconds(300); // can shoot bullet only every 0.3 seconds
-                bulletFireClock.restart();
+                nextState = STATE_PLAYING;
             }
-            // Metoer spawning
-            if (meteorSpawnClock.getElapsedTime().asSeconds() >= nextSpawnTime)
+            else
             {
-                int randomCol = rand() % COLS;  // Any random column
-                if (grid[0][randomCol] == 0) // Only spawn if that area is empty
+                // Read the keyboard and let the simulation run the rules for this frame
+                SimInput input;
                 {
-                    grid[0][randomCol] = 2;
+                    PROFILE_SCOPE(PHASE_INPUT);
+                    input.left = Keyboard::isKeyPressed(Keyboard::Left) || Keyboard::isKeyPressed(Keyboard::A);
+                    input.right = Keyboard::isKeyPressed(Keyboard::Right) || Keyboard::isKeyPressed(Keyboard::D);
+                    input.fire = Keyboard::isKeyPressed(Keyboard::Space);
                 }
-                meteorSpawnClock.restart();
-                nextSpawnTime = 1.0f + (rand() % 3);
-            }
-            // Enemy Spawining
-            if (enemySpawnClock.getElapsedTime().asSeconds() >= nextEnemySpawnTime)
-            {
-                int randomCol = rand() % COLS;  // Any random column
-                if (grid[0][randomCol] == 0) // Check empty
                 {
-                    grid[0][randomCol] = 4;
+                    PROFILE_SCOPE(PHASE_SIM);
+                    nextState = stepRewind(sim, rewind, input, frameTime); // sim.step() keeping every tick for R
                 }
-                enemySpawnClock.restart();
-                float baseTime = 2.0f - (level * 0.35f);  // Base spawn time for each level (decreases with level)
-                float variance = 2.5f - (level * 0.35f);  // Random variation int he spawning
-                if (baseTime < 0.5f) // should nowt be too fast
-                    baseTime = 0.5f;
-                if (variance < 1.0f) // should not be too fast
-                    variance = 1.0f;
-                nextEnemySpawnTime = baseTime + (rand() % (int)variance); // calculate time
+                recordTicks(replay, input, sim.stepTicks);
             }
-            // Boos spawning
-            if (level >= 3 && bossSpawnClock.getElapsedTime().asSeconds() >= nextBossSpawnTime)
             {
-                int randomCol = rand() % COLS;  // Any random column
-                if (grid[0][randomCol] == 0) // Check empty
-                {
-                    grid[0][randomCol] = 5;
-                }
-                bossSpawnClock.restart();
-                float bossBaseTime = 10.0f - ((level - 3) * 1.5f);  // Decreases with level
-                float bossVariance = 4.0f;  // Random variation
-                // same logic as enemies
-                if (bossBaseTime < 5.0f)
-                    bossBaseTime = 5.0f;
-                nextBossSpawnTime = bossBaseTime + (rand() % (int)bossVariance);
+                PROFILE_SCOPE(PHASE_PARTICLES);
+                updateParticles(particles, frameTime);
             }
-            // Shield Powerup Spawning
-            if (level >= 3 && shieldPowerupSpawnClock.getElapsedTime().asSeconds() >= nextShieldPowerupSpawnTime)
+            if (nextState != STATE_PLAYING) // the board is about to go away
+                clearParticles(particles);
+            // Sounds raised by the rules, every hit of the step gets a request (the pool limits them)
+            const int cueSounds[SOUND_CUES] = {shootSound, explosionSound, damageSound, levelUpSound};
+            for (int i = 0; i < SOUND_CUES; i++)
             {
-                for (int i = 0; i < MAX_SHIELD_POWERUPS; i++) // separate array for powerups
-                {
-                    if (!shieldPowerupActive[i]) // empty slot
-                    {
-                        int randomCol = rand() % COLS;  // Any random column
-                        shieldPowerupRow[i] = 0;        // Top row
-                        shieldPowerupCol[i] = randomCol;
-                        shieldPowerupActive[i] = true;  // powerup now visible
-                        shieldPowerupDirection[i] = 0;  // move down
-                        break;  // Only 1 powerup
-                    }
-                }
-                shieldPowerupSpawnClock.restart();
-                float shieldBaseTime;
-                float shieldVariance;
-                if (level < 5) // 20-35 seconds for levels 3 and 4
-                {
-                    shieldBaseTime = 20.0f;
-                    shieldVariance = 15.0f;
-                }
-                else // 12-20 seconds for level 5
-                {
-                    shieldBaseTime = 12.0f;
-                    shieldVariance = 8.0f;
-                }
-                nextShieldPowerupSpawnTime = shieldBaseTime + (rand() % (int)shieldVariance); // calculate time
+                if (sim.soundCounts[i] > 0)
+                    soundPool.request(cueSounds[i], sim.soundCounts[i]);
             }
-            // meteor speed
-            float meteorMoveSpeed = 0.7f - ((level - 1) * 0.12f); // speed formula based on level (decreases by 0.12s per level)
-            if (meteorMoveSpeed < 0.333f)  // cannot go below 0.333s
-                meteorMoveSpeed = 0.333f;
-            if (meteorMoveClock.getElapsedTime().asSeconds() >= meteorMoveSpeed)
+            // State changes raised by the rules
+            if (nextState == STATE_LEVEL_UP)
             {
-                // Loop from bottom to top and update meteor positions
-                for (int r = ROWS - 1; r >= 0; r--)
-                {
-                    for (int c = 0; c < COLS; c++)
-                    {
-                        if (grid[r][c] == 2)
-                        {
-                            if (r == ROWS - 1) // check if it goes below screen
-                            {
-                                grid[r][c] = 0; // remove it
-                            }
-                            else
-                            {
-                                grid[r][c] = 0; // Clear current position
-                                if (grid[r + 1][c] == 0 || grid[r + 1][c] == 2)
-                                {
-                                    grid[r + 1][c] = 2;  // Place meteor in new position
-                                }
-                                else if (grid[r + 1][c] == 1) // collision with player
-                                {
-                                    if (hasShield)
-                                    {
-                                        hasShield = false;
-                                        isInvincible = true;
-                                        invincibilityTimer.restart(); // 2s invincibility
-                                        damageSound.play();
-                                    }
-                                    else if (!isInvincible)
-                                    {
-                                        lives--;
-                                        damageSound.play();
-                                        isInvincible = true;
-                                        invincibilityTimer.restart();
-                                        if (lives <= 0) // game over
-                                        {
-                                            saveHighScoreAndGameOver(score, highScore, saveFile, hasSavedGame,
-                                                                   currentState, selectedMenuItem, loseSound);
-                                        }
-                                    }
-                                }
-                                else if (grid[r + 1][c] == 3) // collision with bullet
-                                {
-                                    int meteorPoints = 1 + (rand() % 2); // Random 1-2 points
-                                    score += meteorPoints;
-                                    explosionSound.play();
-                                    grid[r + 1][c] = 0;
-                                    createExplosionEffect(r + 1, c, hitEffectRow, hitEffectCol, hitEffectTimer,
-                                                        hitEffectActive, MAX_HIT_EFFECTS);
-                                }
-                            }
-                        }
-                    }
-                }
-                meteorMoveClock.restart();
-            }
-            // shield powerup movement
-            if (shieldPowerupMoveClock.getElapsedTime().asSeconds() >= 0.5f)
-            {
-                for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
-                {
-                    if (shieldPowerupActive[i])
-                    {
-                        if (shieldPowerupRow[i] >= ROWS - 1) // moves below screen
-                        {
-                            shieldPowerupActive[i] = false;
-                            continue;
-                        }
-                        if (grid[shieldPowerupRow[i]][shieldPowerupCol[i]] == 1) // player claimed shield
-                        {
-                            if (!hasShield) {
-                                hasShield = true;
-                                levelUpSound.play();
-                            }
-                            shieldPowerupActive[i] = false;
-                            continue;
-                        }
-                        shieldPowerupRow[i]++; // move down every time
-                        if (grid[shieldPowerupRow[i]][shieldPowerupCol[i]] == 1) // player claimed shield
-                        {
-                            if (!hasShield) {
-                                hasShield = true;
-                                levelUpSound.play();
-                            }
-                            shieldPowerupActive[i] = false;
-                            continue;
-                        }
-                    }
-                }
-                shieldPowerupMoveClock.restart();  // reset timer
-            }
-            // enemy movement logic
-            float enemyMoveSpeed = 0.7f - ((level - 1) * 0.12f);  // same speed logic as meteors
-            if (enemyMoveClock.getElapsedTime().asSeconds() >= enemyMoveSpeed)
-            {
-                for (int r = ROWS - 1; r >= 0; r--)
-                {
-                    for (int c = 0; c < COLS; c++)
-                    {
-                        if (grid[r][c] == 4)
-                        {
-                            if (r == ROWS - 1) // enemy reached bottom
-                            {
-                                grid[r][c] = 0;
-                                if (hasShield)
-                                {
-                                    hasShield = false;
-                                    isInvincible = true;
-                                    invincibilityTimer.restart();
-                                    damageSound.play();
-                                }
-                                else if (!isInvincible)
-                                {
-                                    lives--;
-                                    damageSound.play();
-                                    isInvincible = true;
-                                    invincibilityTimer.restart();
-                                    if (lives <= 0)
-                                    {
-                                        saveHighScoreAndGameOver(score, highScore, saveFile, hasSavedGame,
-                                                               currentState, selectedMenuItem, loseSound);
-                                    }
-                                }
-                            }
-                            else
-                            {
-                                grid[r][c] = 0;
-                                if (grid[r + 1][c] == 0 || grid[r + 1][c] == 4)
-                                {
-                                    grid[r + 1][c] = 4;
-                                }
-                                else if (grid[r + 1][c] == 1) // collision with player
-                                {
-                                    if (hasShield)
-                                    {
-                                        hasShield = false;
-                                        isInvincible = true;
-                                        invincibilityTimer.restart();
-                                        explosionSound.play();
-                                    }
-                                    else if (!isInvincible)
-                                    {
-                                        lives--;
-                                        damageSound.play();
-                                        isInvincible = true;
-                                        invincibilityTimer.restart();
-                                        if (lives <= 0)
-                                        {
-                                            saveHighScoreAndGameOver(score, highScore, saveFile, hasSavedGame,
-                                                                   currentState, selectedMenuItem, loseSound);
-                                        }
-                                    }
-                                }
-                                else if (grid[r + 1][c] == 3) // collision with bullet
-                                {
-                                    score += 3;  // 3 score
-                                    killCount++; // +1 kill
-                                    explosionSound.play();
-                                    grid[r + 1][c] = 0;
-                                    createExplosionEffect(r + 1, c, hitEffectRow, hitEffectCol, hitEffectTimer,
-                                                        hitEffectActive, MAX_HIT_EFFECTS);
-                                    // check if level up                    
-                                    int killsNeeded = level * 10;
-                                    if (level < MAX_LEVEL && killCount >= killsNeeded)
-                                    {
-                                        level++;
-                                        levelUpSound.play();
-                                        killCount = 0;
-                                        bossMoveCounter = 0;
-                                        clearEntities(grid);
-                                        resetSpaceship(grid, spaceshipCol);
-                                        currentState = STATE_LEVEL_UP;
-                                        levelUpTimer.restart(); // level up screen time
-                                        levelUpBlinkClock.restart();
-                                    }
-                                    else if (level >= MAX_LEVEL && killCount >= killsNeeded)
-                                    {
-                                        saveHighScoreAndVictory(score, highScore, saveFile, hasSavedGame,
-                                                              currentState, selectedMenuItem, winSound);
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-                enemyMoveClock.restart();
-            }
-            // boss movement logic
-            float bossMoveSpeed = 0.8f - ((level - 3) * 0.1f);  // same speed logic as enemies
-            if (bossMoveSpeed < 0.5f) // cannot go below 0.5s
-                bossMoveSpeed = 0.5f;
-            if (bossMoveClock.getElapsedTime().asSeconds() >= bossMoveSpeed)
-            {
-                for (int r = ROWS - 1; r >= 0; r--)
-                {
-                    for (int c = 0; c < COLS; c++)
-                    {
-                        if (grid[r][c] == 5)
-                        {
-                            if (r == ROWS - 1) // bottom of screen
-                            {
-                                grid[r][c] = 0;
-                                if (hasShield)
-                                {
-                                    hasShield = false;
-                                    isInvincible = true;
-                                    invincibilityTimer.restart();
-                                    damageSound.play();
-                                }
-                                else if (!isInvincible)
-                                {
-                                    lives--;
-                                    damageSound.play();
-                                    isInvincible = true;
-                                    invincibilityTimer.restart();
-                                    if (lives <= 0)
-                                    {
-                                        saveHighScoreAndGameOver(score, highScore, saveFile, hasSavedGame,
-                                                               currentState, selectedMenuItem, loseSound);
-                                    }
-                                }
-                            }
-                            else
-                            {
-                                int nextRow = r + 1;
-                                int nextCell = grid[nextRow][c];
-                                grid[r][c] = 0;
-                                if (nextCell == 0 || nextCell == 5 || nextCell == 6 || nextCell == 2 || nextCell == 4) // move down
-                                {
-                                    grid[nextRow][c] = 5;
-                                }
-                                else if (nextCell == 1) // collision with player
-                                {
-                                    if (hasShield)
-                                    {
-                                        hasShield = false;
-                                        isInvincible = true;
-                                        invincibilityTimer.restart();
-                                        explosionSound.play();
-                                    }
-                                    else if (!isInvincible)
-                                    {
-                                        lives--;
-                                        damageSound.play();
-                                        isInvincible = true;
-                                        invincibilityTimer.restart();
-                                        if (lives <= 0)
-                                        {
-                                            saveHighScoreAndGameOver(score, highScore, saveFile, hasSavedGame,
-                                                                   currentState, selectedMenuItem, loseSound);
-                                        }
-                                    }
-                                }
-                                else if (nextCell == 3) // collision with bullet
-                                {
-                                    score += 5;  // 5 points
-                                    killCount++; // +1 kill
-                                    explosionSound.play();
-                                    grid[nextRow][c] = 0;
-                                    createExplosionEffect(nextRow, c, hitEffectRow, hitEffectCol, hitEffectTimer,
-                                                        hitEffectActive, MAX_HIT_EFFECTS);
-                                    // same level up check logic                    
-                                    int killsNeeded = level * 10;
-                                    if (level < MAX_LEVEL && killCount >= killsNeeded)
-                                    {
-                                        level++;
-                                        levelUpSound.play();
-                                        killCount = 0;
-                                        bossMoveCounter = 0;
-                                        clearEntities(grid);
-                                        resetSpaceship(grid, spaceshipCol);
-                                        currentState = STATE_LEVEL_UP;
-                                        levelUpTimer.restart();
-                                        levelUpBlinkClock.restart();
-                                    }
-                                    else if (level >= MAX_LEVEL && killCount >= killsNeeded)
-                                    {
-                                        saveHighScoreAndVictory(score, highScore, saveFile, hasSavedGame,
-                                                              currentState, selectedMenuItem, winSound);
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-                // Boss bullet firing logic
-                bossMoveCounter++; // boss has moved
-                float firingInterval;
-                if (level == 3)
-                {
-                    firingInterval = 4; // fire bullet every 4 movements
-                }
-                else if (level == 4)
-                {
-                    firingInterval = 3; // fire every 3 movements
-                }
-                else
-                {
-                    firingInterval = 2; // fire every 2 movements
-                }
-                if (bossMoveCounter >= firingInterval)
-                {
-                    for (int r = 0; r < ROWS; r++)
-                    {
-                        for (int c = 0; c < COLS; c++)
-                        {
-                            if (grid[r][c] == 5)
-                            {
-                                if (r < ROWS - 1)
-                                {
-                                    int bulletRow = r + 1;  // just below the boss
-                                    if (bulletRow < ROWS && grid[bulletRow][c] == 0)
-                                    {
-                                        grid[bulletRow][c] = 6; // create bullet
-                                    }
-                                }
-                            }
-                        }
-                    }
-                    bossMoveCounter = 0; // counter reset
-                }
-                bossMoveClock.restart();
-            }
-            // boss bullet miovement logic
-            float bossBulletSpeed = 0.15f; // Move every 0.15 seconds (very fast, regardless of level)
-            if (bossBulletMoveClock.getElapsedTime().asSeconds() >= bossBulletSpeed)
-            {
-                for (int r = ROWS - 1; r >= 0; r--)
-                {
-                    for (int c = 0; c < COLS; c++)
-                    {
-                        if (grid[r][c] == 6)
-                        {
-                            if (r == ROWS - 1)
-                            {
-                                grid[r][c] = 0; // remove when below screen
-                            }
-                            else
-                            {
-                                grid[r][c] = 0; // Clear current position
-                                if (grid[r + 1][c] == 1) // collision with player
-                                {
-                                    if (hasShield)
-                                    {
-                                        hasShield = false;
-                                        isInvincible = true;
-                                        invincibilityTimer.restart();
-                                        explosionSound.play();
-                                    }
-                                    else if (!isInvincible)
-                                    {
-                                        lives--;
-                                        damageSound.play();
-                                        isInvincible = true;
-                                        invincibilityTimer.restart();
-                                        if (lives <= 0)
-                                        {
-                                            saveHighScoreAndGameOver(score, highScore, saveFile, hasSavedGame,
-                                                                   currentState, selectedMenuItem, loseSound);
-                                        }
-                                    }
-                                    createExplosionEffect(r + 1, c, hitEffectRow, hitEffectCol, hitEffectTimer,
-                                                        hitEffectActive, MAX_HIT_EFFECTS);
-                                }
-                                else if (grid[r + 1][c] == 2 || grid[r + 1][c] == 4)
-                                {
-                                    grid[r + 1][c] = 6; // bullet moves through anything
-                                }
-                                else if (grid[r + 1][c] == 0 || grid[r + 1][c] == 6)
-                                {
-                                    grid[r + 1][c] = 6;
-                                }
-                            }
-                        }
-                    }
-                }
-                bossBulletMoveClock.restart();
+                currentState = STATE_LEVEL_UP;
+                levelUpTimer.restart(); // level up screen time
+                levelUpBlinkClock.restart();
             }
-            // player bullet movement logic almost the same as the boss one
-            if (bulletMoveClock.getElapsedTime().asSeconds() >= 0.05f)
+            else if (replaying && nextState != STATE_PLAYING) // playback over, a replay never touches the save file
             {
-                for (int r = 0; r < ROWS; r++)
-                {
-                    for (int c = 0; c < COLS; c++)
-                    {
-                        if (grid[r][c] == 3)
-                        {
-                            if (r == 0)
-                            {
-                                grid[r][c] = 0; // goes above screen
-                            }
-                            else
-                            {
-                                grid[r][c] = 0;
-                                if (grid[r - 1][c] == 0 || grid[r - 1][c] == 3)
-                                {
-                                    grid[r - 1][c] = 3;  // Move bullet up
-                                }
-                                else if (grid[r - 1][c] == 6) // bullet vs boss bullet
-                                {
-                                    explosionSound.play();
-                                    grid[r - 1][c] = 0; // Destroy both bullets
-                                    createExplosionEffect(r - 1, c, hitEffectRow, hitEffectCol, hitEffectTimer,
-                                                        hitEffectActive, MAX_HIT_EFFECTS);
-                                }
-                                else if (grid[r - 1][c] == 2) // bullet vs meteor
-                                {
-                                    int meteorPoints = 1 + (rand() % 2);
-                                    score += meteorPoints;
-                                    explosionSound.play();
-                                    grid[r - 1][c] = 0;
-                                    createExplosionEffect(r - 1, c, hitEffectRow, hitEffectCol, hitEffectTimer,
-                                                        hitEffectActive, MAX_HIT_EFFECTS);
-                                }
-                                else if (grid[r - 1][c] == 4) // bullet vs enemy
-                                {
-                                    score += 3;
-                                    killCount++;
-                                    explosionSound.play();
-                                    grid[r - 1][c] = 0;
-                                    createExplosionEffect(r - 1, c, hitEffectRow, hitEffectCol, hitEffectTimer,
-                                                        hitEffectActive, MAX_HIT_EFFECTS);
-                                    // levle up check
-                                    int killsNeeded = level * 10;
-                                    if (level < MAX_LEVEL && killCount >= killsNeeded)
-                                    {
-                                        level++;
-                                        levelUpSound.play();
-                                        killCount = 0;
-                                        bossMoveCounter = 0;
-                                        clearEntities(grid);
-                                        resetSpaceship(grid, spaceshipCol);
-                                        currentState = STATE_LEVEL_UP;
-                                        levelUpTimer.restart();
-                                        levelUpBlinkClock.restart();
-                                    }
-                                    else if (level >= MAX_LEVEL && killCount >= killsNeeded)
-                                    {
-                                        saveHighScoreAndVictory(score, highScore, saveFile, hasSavedGame,
-                                                              currentState, selectedMenuItem, winSound);
-                                    }
-                                }
-                                else if (grid[r - 1][c] == 5) // bullet vs boss
-                                {
-                                    score += 5;
-                                    killCount++;
-                                    explosionSound.play();
-                                    grid[r - 1][c] = 0;
-                                    createExplosionEffect(r - 1, c, hitEffectRow, hitEffectCol, hitEffectTimer,
-                                                        hitEffectActive, MAX_HIT_EFFECTS);
-                                    int killsNeeded = level * 10;
-                                    if (level < MAX_LEVEL && killCount >= killsNeeded)
-                                    {
-                                        level++;
-                                        levelUpSound.play();
-                                        killCount = 0;
-                                        bossMoveCounter = 0;
-                                        clearEntities(grid);
-                                        resetSpaceship(grid, spaceshipCol);
-                                        currentState = STATE_LEVEL_UP;
-                                        levelUpTimer.restart();
-                                        levelUpBlinkClock.restart();
-                                    }
-                                    else if (level >= MAX_LEVEL && killCount >= killsNeeded)
-                                    {
-                                        saveHighScoreAndVictory(score, highScore, saveFile, hasSavedGame,
-                                                              currentState, selectedMenuItem, winSound);
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-                bulletMoveClock.restart();
+                reportPlayback(replay, sim);
+                replaying = false;
+                if (nextState == STATE_GAME_OVER)
+                    soundPool.request(loseSound);
+                else if (nextState == STATE_VICTORY)
+                    soundPool.request(winSound);
+                else if (bgMusic.getStatus() != Music::Playing)
+                    bgMusic.play();
+                currentState = nextState;
+                selectedMenuItem = 0;
             }
-            // hit effect management
-            float deltaTime = hitEffectClock.getElapsedTime().asSeconds();
-            for (int i = 0; i < MAX_HIT_EFFECTS; i++)
+            else if (nextState == STATE_GAME_OVER)
             {
-                if (hitEffectActive[i])  // all the active effects
-                {
-                    hitEffectTimer[i] += deltaTime;  // time passes
-                    if (hitEffectTimer[i] >= HIT_EFFECT_DURATION)  // check if hit effect visible more than 0.3s
-                    {
-                        hitEffectActive[i] = false; // remove it
-                    }
-                }
+                saveSessionReplay(replay, sim, fileWriter);
+                saveHighScoreAndGameOver(sim.score, highScore, fileWriter, hasSavedGame,
+                                       currentState, selectedMenuItem, soundPool, loseSound);
             }
-            hitEffectClock.restart();
-            if (isInvincible && invincibilityTimer.getElapsedTime().asSeconds() >= INVINCIBILITY_DURATION)  // check if invincibitly over
+            else if (nextState == STATE_VICTORY)
             {
-                isInvincible = false;
+                saveSessionReplay(replay, sim, fileWriter);
+                saveHighScoreAndVictory(sim.score, highScore, fileWriter, hasSavedGame,
+                                      currentState, selectedMenuItem, soundPool, winSound);
             }
         }
         // Level up screen
@@ -1313,9 +873,9 @@ int main()
             if (levelUpTimer.getElapsedTime().asSeconds() >= 2.0f) // after 2s back to playing
             {
                 currentState = STATE_PLAYING;
-                restartAllClocks(meteorSpawnClock, meteorMoveClock, enemySpawnClock, enemyMoveClock,
-                                bossSpawnClock, bossMoveClock, bossBulletMoveClock, bulletMoveClock,
-                                shieldPowerupSpawnClock, shieldPowerupMoveClock);
+                sim.restartTimers();
+                if (!replaying) // a replay restarts the timers itself, from its own record
+                    recordCommand(replay, REPLAY_RESTART_TIMERS);
             }
         }
         // Victory screen
@@ -1327,38 +887,23 @@ int main()
                 if (Keyboard::isKeyPressed(Keyboard::Up) || Keyboard::isKeyPressed(Keyboard::W))
                 {
                     selectedMenuItem = (selectedMenuItem - 1 + 2) % 2;
-                    menuNavSound.play();
+                    soundPool.request(menuNavSound);
                     menuAction = true;
                 }
                 else if (Keyboard::isKeyPressed(Keyboard::Down) || Keyboard::isKeyPressed(Keyboard::S))
                 {
                     selectedMenuItem = (selectedMenuItem + 1) % 2;
-                    menuNavSound.play();
+                    soundPool.request(menuNavSound);
                     menuAction = true;
                 }
                 else if (Keyboard::isKeyPressed(Keyboard::Enter))
                 {
-                    menuClickSound.play();
+                    soundPool.request(menuClickSound);
                     if (selectedMenuItem == 0)  // (restart Game)
                     {
                         currentState = STATE_PLAYING;
                         // start fresh
-                        lives = 3;
-                        score = 0;
-                        killCount = 0;
-                        level = 1;
-                        bossMoveCounter = 0;
-                        isInvincible = false;
-                        hasShield = false;
-                        clearGrid(grid);
-                        for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
-                        {
-                            shieldPowerupActive[i] = false;
-                        }
-                        resetSpaceship(grid, spaceshipCol);
-                        restartAllClocks(meteorSpawnClock, meteorMoveClock, enemySpawnClock, enemyMoveClock,
-                                        bossSpawnClock, bossMoveClock, bossBulletMoveClock, bulletMoveClock,
-                                        shieldPowerupSpawnClock, shieldPowerupMoveClock);
+                        startGame(sim, replay, rewind, 3, 0, 1, seedGiven, givenSeed);
                     }
                     else if (selectedMenuItem == 1)  // (main menu)
                     {
@@ -1387,51 +932,43 @@ int main()
                 if (Keyboard::isKeyPressed(Keyboard::Up) || Keyboard::isKeyPressed(Keyboard::W))
                 {
                     selectedMenuItem = (selectedMenuItem - 1 + 3) % 3;
-                    menuNavSound.play();
+                    soundPool.request(menuNavSound);
                     menuAction = true;
                 }
                 else if (Keyboard::isKeyPressed(Keyboard::Down) || Keyboard::isKeyPressed(Keyboard::S))
                 {
                     selectedMenuItem = (selectedMenuItem + 1) % 3;
-                    menuNavSound.play();
+                    soundPool.request(menuNavSound);
                     menuAction = true;
                 }
                 else if (Keyboard::isKeyPressed(Keyboard::Enter))
                 {
-                    menuClickSound.play();
+                    soundPool.request(menuClickSound);
                     if (selectedMenuItem == 0) // (resume game)
                     {
                         currentState = STATE_PLAYING;
+                        recordCommand(replay, REPLAY_RESUME);
                     }
                     else if (selectedMenuItem == 1)  // (restart level)
                     {
                         currentState = STATE_PLAYING;
-                        killCount = 0;
-                        bossMoveCounter = 0;
-                        isInvincible = false;
-                        hasShield = false;
-                        clearGrid(grid);
-                        for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
-                        {
-                            shieldPowerupActive[i] = false;
-                        }
-                        resetSpaceship(grid, spaceshipCol);
-                        restartAllClocks(meteorSpawnClock, meteorMoveClock, enemySpawnClock, enemyMoveClock,
-                                        bossSpawnClock, bossMoveClock, bossBulletMoveClock, bulletMoveClock,
-                                        shieldPowerupSpawnClock, shieldPowerupMoveClock);
+                        sim.restartLevel();
+                        clearParticles(particles);
+                        recordCommand(replay, REPLAY_RESTART_LEVEL);
                     }
                     else if (selectedMenuItem == 2)  // (save and quit
                     {
-                        ofstream outputFile(saveFile); // open file and save all score etc to it
-                        if (outputFile.is_open())
-                        {
-                            outputFile << highScore << " " << lives << " " << score << " " << level;
-                            outputFile.close();
-                            hasSavedGame = true;
-                            savedLives = lives;
-                            savedScore = score;
-                            savedLevel = level;
-                        }
+                        // save all score etc, the I/O thread writes it
+                        SaveRecord record = makeSaveRecord(highScore, sim.lives, sim.score, sim.level);
+                        fileWriter.write(SAVE_FILE, encodeSaveRecord(record));
+                        quickSave(sim, quickSnapshot, hasQuickSnapshot, fileWriter, record.checksum); // everything else
+                        saveSessionReplay(replay, sim, fileWriter);
+                        clearParticles(particles);
+                        hasSavedGame = true;
+                        savedLives = sim.lives;
+                        savedScore = sim.score;
+                        savedLevel = sim.level;
+                        savedChecksum = record.checksum;
                         if (bgMusic.getStatus() != Music::Playing)
                         {
                             bgMusic.play();
@@ -1444,6 +981,7 @@ int main()
                 else if (Keyboard::isKeyPressed(Keyboard::P))
                 {
                     currentState = STATE_PLAYING;
+                    recordCommand(replay, REPLAY_RESUME);
                     menuAction = true;
                 }
                 if (menuAction)
@@ -1452,184 +990,192 @@ int main()
                 }
             }
         }
+        if (traceEnabled && currentState != tracedState)
+        {
+            traceTextInstant("state change", "state", "from", STATE_NAMES[tracedState], "to", STATE_NAMES[currentState]);
+            tracedState = currentState;
+        }
         // SFML Rendering for each Game Screen
-        window.clear(Color(40, 40, 40)); // Dark Gray Backfground
-        // Menu Screen
+        PROFILE_SCOPE(PHASE_DRAW);
+        // Static part of the screen, drawn again only when the screen or the number on it changes.
+        // It covers the whole window, so nothing needs clearing
+        bool onPlayfield = currentState == STATE_PLAYING || currentState == STATE_LEVEL_UP || currentState == STATE_PAUSED;
+        int screenValue = 0;
         if (currentState == STATE_MENU)
+            screenValue = highScore;
+        else if (currentState == STATE_GAME_OVER || currentState == STATE_VICTORY)
+            screenValue = sim.score;
+        trackLayerValue(screenLayer, 0, onPlayfield ? STATE_PLAYING : currentState);
+        trackLayerValue(screenLayer, 1, screenValue);
+        if (beginLayer(screenLayer, screenColor))
         {
-            window.draw(menuBackground);
-            window.draw(menuTitle);
-            char menuHighScoreBuffer[50];
-            sprintf(menuHighScoreBuffer, "High Score: %d", highScore); // %d fetches from highscore var and updates the string
-            menuHighScoreText.setString(menuHighScoreBuffer);
-            menuHighScoreText.setPosition(windowWidth / 2 - menuHighScoreText.getLocalBounds().width / 2.0f, 180);
-            window.draw(menuHighScoreText);
-            for (int i = 0; i < 4; i++)
+            RenderTexture& layer = screenLayer.texture;
+            if (onPlayfield)
             {
-                menuItems[i].setFillColor(i == selectedMenuItem ? Color::Yellow : Color::White);
-                window.draw(menuItems[i]);
+                layerQuads.clear();
+                batchBackground(layerQuads, atlas);
+                layer.draw(layerQuads, &atlas.texture);
             }
-            window.draw(menuInstructions);
-        }
-        // Instructions Screen
-        else if (currentState == STATE_INSTRUCTIONS)
-        {
-            window.draw(menuBackground);
-            window.draw(instructionsTitle);
-            window.draw(controlsTitle);
-            window.draw(moveText);
-            window.draw(shootText);
-            window.draw(pauseText);
-            window.draw(entitiesTitle);
-            spaceship.setPosition(60, 285);
-            window.draw(spaceship);
-            window.draw(playerDesc);
-            meteor.setPosition(60, 325);
-            window.draw(meteor);
-            window.draw(meteorDesc);
-            enemy.setPosition(60, 365);
-            window.draw(enemy);
-            window.draw(enemyDesc);
-            bossEnemy.setPosition(60, 405);
-            window.draw(bossEnemy);
-            window.draw(bossDesc);
-            bullet.setPosition(60 + BULLET_OFFSET_X, 445);
-            window.draw(bullet);
-            window.draw(bulletDesc);
-            bossBullet.setPosition(60 + BULLET_OFFSET_X, 485);
-            window.draw(bossBullet);
-            window.draw(bossBulletDesc);
-            lifeIcon.setPosition(60 + 8, 525);
-            window.draw(lifeIcon);
-            window.draw(lifeDesc);
-            shieldPowerUp.setPosition(60, 565);
-            window.draw(shieldPowerUp);
-            window.draw(shieldPowerupDesc);
-            window.draw(systemsTitle);
-            window.draw(livesDesc);
-            window.draw(levelsDesc);
-            window.draw(highScoreDesc);
-            window.draw(objectiveTitle);
-            window.draw(objective1);
-            window.draw(objective2);
-            window.draw(objective3);
-            window.draw(instructionsBack);
-        }
-        // Playing Screen
-        else if (currentState == STATE_PLAYING)
-        {
-            window.draw(background);
-            window.draw(gameBox);
-            // File all the grid with relevant sprites based on 0-6
-            for (int r = 0; r < ROWS; r++)
+            else
             {
-                for (int c = 0; c < COLS; c++)
-                {
-                    if (grid[r][c] == 1)
-                    {
-                        spaceship.setPosition(MARGIN + c * CELL_SIZE, MARGIN + r * CELL_SIZE);
-                        if (!isInvincible || ((int)(invincibilityTimer.getElapsedTime().asMilliseconds() / 100) % 2 == 0))
-                        {
-                            window.draw(spaceship);
-                        }
-                    }
-                    else if (grid[r][c] == 2)
-                    {
-                        meteor.setPosition(MARGIN + c * CELL_SIZE, MARGIN + r * CELL_SIZE);
-                        window.draw(meteor);
-                    }
-                    else if (grid[r][c] == 3)
-                    {
-                        bullet.setPosition(MARGIN + c * CELL_SIZE + BULLET_OFFSET_X, MARGIN + r * CELL_SIZE);
-                        window.draw(bullet);
-                    }
-                    else if (grid[r][c] == 4)
-                    {
-                        enemy.setPosition(MARGIN + c * CELL_SIZE, MARGIN + r * CELL_SIZE);
-                        window.draw(enemy);
-                    }
-                    else if (grid[r][c] == 5)
-                    {
-                        bossEnemy.setPosition(MARGIN + c * CELL_SIZE, MARGIN + r * CELL_SIZE);
-                        window.draw(bossEnemy);
-                    }
-                    else if (grid[r][c] == 6)
-                    {
-                        bossBullet.setPosition(MARGIN + c * CELL_SIZE + BULLET_OFFSET_X, MARGIN + r * CELL_SIZE);
-                        window.draw(bossBullet);
-                    }
-                }
+                layer.draw(menuBackground);
             }
-            // Show all powerups
-            for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
+            // Menu Screen
+            if (currentState == STATE_MENU)
             {
-                if (shieldPowerupActive[i])
-                {
-                    shieldPowerUp.setPosition(MARGIN + shieldPowerupCol[i] * CELL_SIZE, MARGIN + shieldPowerupRow[i] * CELL_SIZE); // set posioton relative to the grid
-                    window.draw(shieldPowerUp);
-                }
+                layer.draw(menuTitle);
+                char menuHighScoreBuffer[50];
+                sprintf(menuHighScoreBuffer, "High Score: %d", highScore); // %d fetches from highscore var and updates the string
+                menuHighScoreText.setString(menuHighScoreBuffer);
+                menuHighScoreText.setPosition(windowWidth / 2 - menuHighScoreText.getLocalBounds().width / 2.0f, 180);
+                layer.draw(menuHighScoreText);
+                layer.draw(menuInstructions);
             }
-            if (hasShield) // draw shield over the player
+            // Instructions Screen
+            else if (currentState == STATE_INSTRUCTIONS)
             {
-                shieldIcon.setPosition(MARGIN + spaceshipCol * CELL_SIZE + SHIELD_OFFSET, MARGIN + (ROWS - 1) * CELL_SIZE + SHIELD_OFFSET);
-                window.draw(shieldIcon);
+                layer.draw(instructionsTitle);
+                layer.draw(controlsTitle);
+                layer.draw(moveText);
+                layer.draw(shootText);
+                layer.draw(pauseText);
+                layer.draw(entitiesTitle);
+                spaceship.setPosition(60, 285);
+                layer.draw(spaceship);
+                layer.draw(playerDesc);
+                meteor.setPosition(60, 325);
+                layer.draw(meteor);
+                layer.draw(meteorDesc);
+                enemy.setPosition(60, 365);
+                layer.draw(enemy);
+                layer.draw(enemyDesc);
+                bossEnemy.setPosition(60, 405);
+                layer.draw(bossEnemy);
+                layer.draw(bossDesc);
+                bullet.setPosition(60 + BULLET_OFFSET_X, 445);
+                layer.draw(bullet);
+                layer.draw(bulletDesc);
+                bossBullet.setPosition(60 + BULLET_OFFSET_X, 485);
+                layer.draw(bossBullet);
+                layer.draw(bossBulletDesc);
+                lifeIcon.setPosition(60 + 8, 525);
+                layer.draw(lifeIcon);
+                layer.draw(lifeDesc);
+                shieldPowerUp.setPosition(60, 565);
+                layer.draw(shieldPowerUp);
+                layer.draw(shieldPowerupDesc);
+                layer.draw(systemsTitle);
+                layer.draw(livesDesc);
+                layer.draw(levelsDesc);
+                layer.draw(highScoreDesc);
+                layer.draw(objectiveTitle);
+                layer.draw(objective1);
+                layer.draw(objective2);
+                layer.draw(objective3);
+                layer.draw(instructionsBack);
             }
-            for (int i = 0; i < MAX_HIT_EFFECTS; i++)
+            // Victory Screen
+            else if (currentState == STATE_VICTORY)
             {
-                if (hitEffectActive[i])
-                {
-                    bulletHit.setPosition(MARGIN + hitEffectCol[i] * CELL_SIZE, MARGIN + hitEffectRow[i] * CELL_SIZE);
-                    window.draw(bulletHit);
-                }
+                layer.draw(victoryTitle);
+                char victoryScoreBuffer[50];
+                sprintf(victoryScoreBuffer, "Final Score: %d", sim.score); // same update logic
+                victoryScore.setString(victoryScoreBuffer);
+                victoryScore.setPosition(windowWidth / 2 - victoryScore.getLocalBounds().width / 2.0f, 200);
+                layer.draw(victoryScore);
+                layer.draw(victoryInstructions);
+            }
+            // Game Over Screen
+            else if (currentState == STATE_GAME_OVER)
+            {
+                layer.draw(gameOverTitle);
+                char gameOverScoreBuffer[50];
+                sprintf(gameOverScoreBuffer, "Final Score: %d", sim.score);
+                gameOverScore.setString(gameOverScoreBuffer);
+                gameOverScore.setPosition(windowWidth / 2 - gameOverScore.getLocalBounds().width / 2.0f, 200);
+                layer.draw(gameOverScore);
+                layer.draw(gameOverInstructions);
+            }
+            endLayer(screenLayer);
+        }
+        drawLayer(window, screenLayer);
+        // What changes from frame to frame goes on top
+        // Menu Screen
+        if (currentState == STATE_MENU)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                menuItems[i].setFillColor(i == selectedMenuItem ? Color::Yellow : Color::White);
+                window.draw(menuItems[i]);
             }
-            livesText.setString("Lives:");
+        }
+        // Playing Screen
+        else if (currentState == STATE_PLAYING)
+        {
+            // Whole playfield in one batch: grid, powerups, shield, effects and life icons
+            playfield.clear();
+            batchGrid(playfield, atlas, sim, true);
+            batchOverlays(playfield, atlas, sim);
             // Icon for lives remaining
             float lifeIconStartX = livesText.getPosition().x + livesText.getLocalBounds().width + 10;
             float lifeIconY = livesText.getPosition().y + (livesText.getLocalBounds().height / 2.0f) - 12;
-            for (int i = 0; i < lives; i++) // draw based on how many left
+            batchLives(playfield, atlas, sim.lives, lifeIconStartX, lifeIconY);
+            window.draw(playfield, &atlas.texture);
+            batchParticles(particleQuads, particles);
+            window.draw(particleQuads, BlendAdd);
+            window.draw(gameBox);
+            // Sidebar text, drawn again only when one of its numbers changes
+            trackLayerValue(hudLayer, 0, sim.score);
+            trackLayerValue(hudLayer, 1, sim.killCount);
+            trackLayerValue(hudLayer, 2, sim.level);
+            trackLayerValue(hudLayer, 3, highScore);
+            if (beginLayer(hudLayer, Color::Transparent))
             {
-                lifeIcon.setPosition(lifeIconStartX + (i * 28), lifeIconY); // + (i*28) so that they dont draw on top of each other
-                window.draw(lifeIcon);
+                PROFILE_SCOPE(PHASE_HUD);
+                RenderTexture& layer = hudLayer.texture;
+                char scoreBuffer[20];
+                sprintf(scoreBuffer, "Score: %d", sim.score); // same update logic
+                scoreText.setString(scoreBuffer);
+                char killsBuffer[50];
+                sprintf(killsBuffer, "Kills: %d/%d", sim.killCount, sim.level * 10);
+                killsText.setString(killsBuffer);
+                char levelBuffer[20];
+                sprintf(levelBuffer, "Level: %d", sim.level);
+                levelText.setString(levelBuffer);
+                char highScoreBuffer[50];
+                sprintf(highScoreBuffer, "High Score: %d", highScore);
+                highScoreText.setString(highScoreBuffer);
+                layer.draw(title);
+                layer.draw(livesText);
+                layer.draw(scoreText);
+                layer.draw(killsText);
+                layer.draw(levelText);
+                layer.draw(highScoreText);
+                endLayer(hudLayer);
             }
-            char scoreBuffer[20];
-            sprintf(scoreBuffer, "Score: %d", score); // same update logic
-            scoreText.setString(scoreBuffer);
-            char killsBuffer[50];
-            sprintf(killsBuffer, "Kills: %d/%d", killCount, level * 10);
-            killsText.setString(killsBuffer);
-            char levelBuffer[20];
-            sprintf(levelBuffer, "Level: %d", level);
-            levelText.setString(levelBuffer);
-            char highScoreBuffer[50];
-            sprintf(highScoreBuffer, "High Score: %d", highScore);
-            highScoreText.setString(highScoreBuffer);
-            window.draw(title);
-            window.draw(livesText);
-            window.draw(scoreText);
-            window.draw(killsText);
-            window.draw(levelText);
-            window.draw(highScoreText);
+            drawLayer(window, hudLayer);
         }
         // Level Up Screen
         else if (currentState == STATE_LEVEL_UP)
         {
-            window.draw(background);
+            // entities were cleared on level up, so the grid only holds the spaceship
+            playfield.clear();
+            batchGrid(playfield, atlas, sim, false);
+            window.draw(playfield, &atlas.texture);
             window.draw(gameBox);
-            spaceship.setPosition(MARGIN + spaceshipCol * CELL_SIZE, MARGIN + (ROWS - 1) * CELL_SIZE);
-            window.draw(spaceship);
             if (levelUpBlinkState)
             {
                 window.draw(levelUpText);
             }
             char levelBuffer[20];
-            sprintf(levelBuffer, "Level: %d", level);
+            sprintf(levelBuffer, "Level: %d", sim.level);
             levelText.setString(levelBuffer);
 
             char killsBuffer[50];
-            sprintf(killsBuffer, "Kills: %d/%d", killCount, level * 10);
+            sprintf(killsBuffer, "Kills: %d/%d", sim.killCount, sim.level * 10);
             killsText.setString(killsBuffer);
 
-            // Draw UI elements (same as gameplay screen)
+            // Draw UI elements (same as gameplay screen, no life icons or high score)
             window.draw(title);
             window.draw(livesText);
             window.draw(scoreText);
@@ -1639,44 +1185,10 @@ int main()
         // Pause Screen
         else if (currentState == STATE_PAUSED)
         {
-            window.draw(background);
+            playfield.clear();
+            batchGrid(playfield, atlas, sim, false);
+            window.draw(playfield, &atlas.texture);
             window.draw(gameBox);
-            for (int r = 0; r < ROWS; r++)
-            {
-                for (int c = 0; c < COLS; c++)
-                {
-                    if (grid[r][c] == 1)  // Spaceship
-                    {
-                        spaceship.setPosition(MARGIN + c * CELL_SIZE, MARGIN + r * CELL_SIZE);
-                        window.draw(spaceship);
-                    }
-                    else if (grid[r][c] == 2)  // Meteor
-                    {
-                        meteor.setPosition(MARGIN + c * CELL_SIZE, MARGIN + r * CELL_SIZE);
-                        window.draw(meteor);
-                    }
-                    else if (grid[r][c] == 3)  // Player Bullet
-                    {
-                        bullet.setPosition(MARGIN + c * CELL_SIZE + BULLET_OFFSET_X, MARGIN + r * CELL_SIZE);
-                        window.draw(bullet);
-                    }
-                    else if (grid[r][c] == 4)  // Enemy
-                    {
-                        enemy.setPosition(MARGIN + c * CELL_SIZE, MARGIN + r * CELL_SIZE);
-                        window.draw(enemy);
-                    }
-                    else if (grid[r][c] == 5)  // Boss
-                    {
-                        bossEnemy.setPosition(MARGIN + c * CELL_SIZE, MARGIN + r * CELL_SIZE);
-                        window.draw(bossEnemy);
-                    }
-                    else if (grid[r][c] == 6)  // Boss Bullet
-                    {
-                        bossBullet.setPosition(MARGIN + c * CELL_SIZE + BULLET_OFFSET_X, MARGIN + r * CELL_SIZE);
-                        window.draw(bossBullet);
-                    }
-                }
-            }
             RectangleShape overlay(Vector2f(COLS * CELL_SIZE, ROWS * CELL_SIZE));
             overlay.setPosition(MARGIN, MARGIN);
             overlay.setFillColor(Color(0, 0, 0, 150)); // semi transparent background
@@ -1691,39 +1203,45 @@ int main()
         // Victory Screen
         else if (currentState == STATE_VICTORY)
         {
-            window.draw(menuBackground);
-            window.draw(victoryTitle);
-            char victoryScoreBuffer[50];
-            sprintf(victoryScoreBuffer, "Final Score: %d", score); // same update logic
-            victoryScore.setString(victoryScoreBuffer);
-            victoryScore.setPosition(windowWidth / 2 - victoryScore.getLocalBounds().width / 2.0f, 200);
-            window.draw(victoryScore);
             for (int i = 0; i < 2; i++)
             {
                 victoryItems[i].setFillColor(i == selectedMenuItem ? Color::Yellow : Color::White);
                 window.draw(victoryItems[i]);
             }
-            window.draw(victoryInstructions);
         }
         // Game Over Screen
         else if (currentState == STATE_GAME_OVER)
         {
-            window.draw(menuBackground);
-            window.draw(gameOverTitle);
-            char gameOverScoreBuffer[50];
-            sprintf(gameOverScoreBuffer, "Final Score: %d", score);
-            gameOverScore.setString(gameOverScoreBuffer);
-            gameOverScore.setPosition(windowWidth / 2 - gameOverScore.getLocalBounds().width / 2.0f, 200);
-            window.draw(gameOverScore);
             for (int i = 0; i < 2; i++)
             {
                 gameOverItems[i].setFillColor(i == selectedMenuItem ? Color::Yellow : Color::White);
                 window.draw(gameOverItems[i]);
             }
-            window.draw(gameOverInstructions);
         }
+#if ENABLE_PROFILER
+        if (currentState == STATE_PLAYING && showProfiler)
+        {
+            if (profilerRefresh-- <= 0) // rebuilding the text every frame would show up in the numbers
+            {
+                PROFILE_SCOPE(PHASE_HUD);
+                updateProfilerOverlay(profilerText, profilerBars, sim);
+                profilerRefresh = 15;
+            }
+            window.draw(profilerText);
+            window.draw(profilerBars);
+        }
+#endif
+        // Start this frame's sounds in one go
+        soundPool.flush();
         // After Drawing everything, display it on the screen
-        window.display();
+        {
+            PROFILE_SCOPE(PHASE_DISPLAY);
+            window.display();
+        }
     }
+    // Window closed in the middle of a game: keep what was played so far
+    if (!replaying && (currentState == STATE_PLAYING || currentState == STATE_PAUSED || currentState == STATE_LEVEL_UP))
+        saveSessionReplay(replay, sim, fileWriter);
+    stopTrace();
     return 0;
 }
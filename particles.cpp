@@ -0,0 +1,174 @@
+#include "particles.h"
+// C++ libraries
+#include <cmath>
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+// namespaces
+using namespace std;
+
+// Uniform in [0, 1)
+float randomUnit(Pcg32& rng)
+{
+    return static_cast<float>(nextRandom(rng) >> 8) * (1.0f / 16777216.0f);
+}
+
+void initParticles(ParticleSystem& particles, uint64_t seed)
+{
+    vector<float>* fields[] = {&particles.x,    &particles.y,    &particles.vx, &particles.vy, &particles.life,
+                               &particles.fade, &particles.r,    &particles.g,  &particles.b};
+    for (vector<float>* field : fields)
+    {
+        field->assign(MAX_PARTICLES, 0.0f);
+    }
+    particles.count = 0;
+    particles.dropped = 0;
+    seedRandom(particles.rng, seed, 0);
+}
+void clearParticles(ParticleSystem& particles)
+{
+    particles.count = 0;
+}
+// One particle, unless the buffers are full
+void emitParticle(ParticleSystem& particles, float x, float y, float vx, float vy, float life, float r, float g,
+                  float b)
+{
+    if (particles.count >= MAX_PARTICLES)
+    {
+        particles.dropped++;
+        return;
+    }
+    int i = particles.count++;
+    particles.x[i] = x;
+    particles.y[i] = y;
+    particles.vx[i] = vx;
+    particles.vy[i] = vy;
+    particles.life[i] = life;
+    particles.fade[i] = 1.0f / life;
+    particles.r[i] = r;
+    particles.g[i] = g;
+    particles.b[i] = b;
+}
+void emitBurst(ParticleSystem& particles, float x, float y, int amount, float speed, float life, float r, float g,
+               float b)
+{
+    for (int i = 0; i < amount; i++)
+    {
+        float angle = randomUnit(particles.rng) * 6.2831853f;
+        float v = speed * (0.2f + 0.8f * randomUnit(particles.rng)); // some linger near the middle
+        float shade = 0.7f + 0.3f * randomUnit(particles.rng);
+        emitParticle(particles, x, y, cos(angle) * v, sin(angle) * v, life * (0.5f + randomUnit(particles.rng)),
+                     r * shade, g * shade, b * shade);
+    }
+}
+void emitRing(ParticleSystem& particles, float x, float y, int amount, float radius, float speed, float life,
+              float r, float g, float b)
+{
+    for (int i = 0; i < amount; i++)
+    {
+        float angle = (i + randomUnit(particles.rng)) * 6.2831853f / amount;
+        float dx = cos(angle);
+        float dy = sin(angle);
+        emitParticle(particles, x + dx * radius, y + dy * radius, dx * speed, dy * speed,
+                     life * (0.8f + 0.4f * randomUnit(particles.rng)), r, g, b);
+    }
+}
+// Integrate particles [first, last) one at a time, the SIMD loops leave the remainder to this
+void updateScalar(ParticleSystem& particles, int first, int last, float dt, float keep)
+{
+    float fall = PARTICLE_GRAVITY * dt;
+    for (int i = first; i < last; i++)
+    {
+        particles.vx[i] *= keep;
+        particles.vy[i] = particles.vy[i] * keep + fall;
+        particles.x[i] += particles.vx[i] * dt;
+        particles.y[i] += particles.vy[i] * dt;
+        particles.life[i] -= dt;
+    }
+}
+void updateParticles(ParticleSystem& particles, float dt)
+{
+    float keep = 1.0f - PARTICLE_DRAG * dt;
+    if (keep < 0.0f)
+        keep = 0.0f;
+    float* x = particles.x.data();
+    float* y = particles.y.data();
+    float* vx = particles.vx.data();
+    float* vy = particles.vy.data();
+    float* life = particles.life.data();
+    int count = particles.count;
+    int i = 0;
+    int died = 0; // any lane that burnt out, so the compaction below can be skipped
+#if defined(__AVX__)
+    __m256 dt8 = _mm256_set1_ps(dt);
+    __m256 keep8 = _mm256_set1_ps(keep);
+    __m256 fall8 = _mm256_set1_ps(PARTICLE_GRAVITY * dt);
+    __m256 zero8 = _mm256_setzero_ps();
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 pvx = _mm256_mul_ps(_mm256_loadu_ps(vx + i), keep8);
+        __m256 pvy = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(vy + i), keep8), fall8);
+        _mm256_storeu_ps(vx + i, pvx);
+        _mm256_storeu_ps(vy + i, pvy);
+        _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(pvx, dt8)));
+        _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(pvy, dt8)));
+        __m256 left = _mm256_sub_ps(_mm256_loadu_ps(life + i), dt8);
+        _mm256_storeu_ps(life + i, left);
+        died |= _mm256_movemask_ps(_mm256_cmp_ps(left, zero8, _CMP_LE_OQ));
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128 dt4 = _mm_set1_ps(dt);
+    __m128 keep4 = _mm_set1_ps(keep);
+    __m128 fall4 = _mm_set1_ps(PARTICLE_GRAVITY * dt);
+    __m128 zero4 = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 pvx = _mm_mul_ps(_mm_loadu_ps(vx + i), keep4);
+        __m128 pvy = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(vy + i), keep4), fall4);
+        _mm_storeu_ps(vx + i, pvx);
+        _mm_storeu_ps(vy + i, pvy);
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(pvx, dt4)));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(pvy, dt4)));
+        __m128 left = _mm_sub_ps(_mm_loadu_ps(life + i), dt4);
+        _mm_storeu_ps(life + i, left);
+        died |= _mm_movemask_ps(_mm_cmple_ps(left, zero4));
+    }
+#endif
+    updateScalar(particles, i, count, dt, keep);
+    for (; i < count; i++)
+    {
+        if (life[i] <= 0.0f)
+            died = 1;
+    }
+    if (!died)
+        return;
+    // the last live particle takes the place of a dead one
+    for (int p = 0; p < particles.count;)
+    {
+        if (life[p] > 0.0f)
+        {
+            p++;
+            continue;
+        }
+        int last = --particles.count;
+        x[p] = x[last];
+        y[p] = y[last];
+        vx[p] = vx[last];
+        vy[p] = vy[last];
+        life[p] = life[last];
+        particles.fade[p] = particles.fade[last];
+        particles.r[p] = particles.r[last];
+        particles.g[p] = particles.g[last];
+        particles.b[p] = particles.b[last];
+    }
+}
+const char* particleSimd()
+{
+#if defined(__AVX__)
+    return "AVX";
+#elif defined(__SSE2__) || defined(_M_X64)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,65 @@
+#include "profiler.h"
+// C++ libraries
+#include <algorithm>
+// namespaces
+using namespace std;
+
+const char* const PHASE_NAMES[PHASE_COUNT] = {"input", "sim", "particles", "hud", "draw", "display", "frame"};
+
+FrameProfiler frameProfiler = {};
+ProfileScope* ProfileScope::innermost = nullptr;
+
+void profileEndFrame()
+{
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    if (frameProfiler.frameStart != chrono::steady_clock::time_point()) // the first call only starts timing
+    {
+        frameProfiler.current[PHASE_FRAME] = profileNanoseconds(now - frameProfiler.frameStart);
+        if (traceEnabled)
+            traceSpan(PHASE_NAMES[PHASE_FRAME], "frame", frameProfiler.frameStart, now);
+        for (int phase = 0; phase < PHASE_COUNT; phase++)
+        {
+            frameProfiler.history[phase][frameProfiler.next] = frameProfiler.current[phase];
+        }
+        frameProfiler.next = (frameProfiler.next + 1) % PROFILE_FRAMES;
+        if (frameProfiler.frames < PROFILE_FRAMES)
+            frameProfiler.frames++;
+    }
+    for (int phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        frameProfiler.current[phase] = 0;
+    }
+    frameProfiler.frameStart = now;
+}
+PhaseStats phaseStats(int phase)
+{
+    PhaseStats stats = {0.0, 0.0, 0.0};
+    int frames = frameProfiler.frames;
+    if (frames == 0)
+        return stats;
+    int64_t sorted[PROFILE_FRAMES];
+    int64_t total = 0;
+    for (int i = 0; i < frames; i++)
+    {
+        sorted[i] = frameProfiler.history[phase][i];
+        total += sorted[i];
+    }
+    int p99 = (frames * 99) / 100;
+    nth_element(sorted, sorted + p99, sorted + frames);
+    stats.averageMs = total / 1e6 / frames;
+    stats.p99Ms = sorted[p99] / 1e6;
+    stats.maxMs = *max_element(sorted, sorted + frames) / 1e6;
+    return stats;
+}
+void frameHistogram(int counts[HISTOGRAM_BUCKETS])
+{
+    for (int b = 0; b < HISTOGRAM_BUCKETS; b++)
+    {
+        counts[b] = 0;
+    }
+    for (int i = 0; i < frameProfiler.frames; i++)
+    {
+        int bucket = static_cast<int>(frameProfiler.history[PHASE_FRAME][i] / 1e6 / HISTOGRAM_BUCKET_MS);
+        counts[min(bucket, HISTOGRAM_BUCKETS - 1)]++;
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+// Frame profiler: PROFILE_SCOPE(phase) times a block of the main loop, the totals of each frame
+// are kept for the last PROFILE_FRAMES frames so the F3 overlay can show averages, p99 and a
+// frame time histogram.
+// Scopes are exclusive: a scope opened inside another one pauses it, so the phases of a frame add
+// up to at most the frame time. Main thread only.
+// While a --trace is running every scope and every frame also goes out as a trace span.
+// With ENABLE_PROFILER=0 (the CMake option, off by default in Release builds) the macros are empty.
+#include "trace.h"
+#include <chrono>
+#include <cstdint>
+
+#ifndef ENABLE_PROFILER
+#define ENABLE_PROFILER 0
+#endif
+
+// Phases of a frame
+const int PHASE_INPUT = 0;     // events and keyboard polling
+const int PHASE_SIM = 1;       // the rules: every tick the frame ran (bench times the kernels inside one)
+const int PHASE_PARTICLES = 2; // explosion particles moving
+const int PHASE_HUD = 3;       // sidebar text formatting
+const int PHASE_DRAW = 4;      // batching and window.draw
+const int PHASE_DISPLAY = 5;   // window.display, including the frame limit wait
+const int PHASE_FRAME = 6;     // the whole frame, filled in by profileEndFrame()
+const int PHASE_COUNT = 7;
+const int PROFILE_FRAMES = 240;  // 4s at 60 fps
+// Frame time histogram: 2ms buckets, the last one holds everything slower
+const int HISTOGRAM_BUCKETS = 17;
+const double HISTOGRAM_BUCKET_MS = 2.0;
+
+extern const char* const PHASE_NAMES[PHASE_COUNT];
+
+struct PhaseStats
+{
+    double averageMs;
+    double p99Ms;
+    double maxMs;
+};
+
+struct FrameProfiler
+{
+    int64_t current[PHASE_COUNT];                 // nanoseconds so far this frame
+    int64_t history[PHASE_COUNT][PROFILE_FRAMES]; // ring of finished frames
+    int frames;                                   // finished frames in the ring (up to PROFILE_FRAMES)
+    int next;                                     // where the next one goes
+    std::chrono::steady_clock::time_point frameStart;
+};
+extern FrameProfiler frameProfiler;
+
+inline int64_t profileNanoseconds(std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+// Close the current frame and start the next one
+void profileEndFrame();
+PhaseStats phaseStats(int phase);
+void frameHistogram(int counts[HISTOGRAM_BUCKETS]);
+
+struct ProfileScope
+{
+    int phase;
+    std::chrono::steady_clock::time_point begin;
+    std::chrono::steady_clock::time_point start; // begin, or when an inner scope last closed
+    ProfileScope* outer;
+    static ProfileScope* innermost;
+
+    explicit ProfileScope(int scopePhase) : phase(scopePhase), begin(std::chrono::steady_clock::now()), start(begin), outer(innermost)
+    {
+        if (outer) // pause the enclosing phase
+            frameProfiler.current[outer->phase] += profileNanoseconds(start - outer->start);
+        innermost = this;
+    }
+    ~ProfileScope()
+    {
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        frameProfiler.current[phase] += profileNanoseconds(end - start);
+        if (traceEnabled)
+            traceSpan(PHASE_NAMES[phase], "phase", begin, end);
+        if (outer)
+            outer->start = end;
+        innermost = outer;
+    }
+};
+
+#if ENABLE_PROFILER
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(phase) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(phase)
+#define PROFILE_END_FRAME() profileEndFrame()
+#else
+#define PROFILE_SCOPE(phase) ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+// PCG32 random numbers (pcg-random.org, XSH-RR variant): 64-bit state, 32-bit output.
+// Every generator is seeded explicitly and picks a stream, generators on different streams
+// give unrelated sequences from the same seed, so each subsystem can own one.
+#include <cstdint>
+
+struct Pcg32
+{
+    uint64_t state;
+    uint64_t increment; // always odd, selects the stream
+};
+
+inline uint32_t nextRandom(Pcg32& rng)
+{
+    uint64_t old = rng.state;
+    rng.state = old * 6364136223846793005ull + rng.increment;
+    uint32_t xorShifted = static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u);
+    uint32_t rotation = static_cast<uint32_t>(old >> 59u);
+    return (xorShifted >> rotation) | (xorShifted << ((32u - rotation) & 31u));
+}
+inline void seedRandom(Pcg32& rng, uint64_t seed, uint64_t stream)
+{
+    rng.state = 0;
+    rng.increment = (stream << 1u) | 1u;
+    nextRandom(rng);
+    rng.state += seed;
+    nextRandom(rng);
+}
+// Uniform in [0, bound), without the modulo bias of rand() % bound
+inline int randomBelow(Pcg32& rng, int bound)
+{
+    uint32_t range = static_cast<uint32_t>(bound);
+    uint32_t threshold = (0u - range) % range; // values below this would favour small results
+    while (true)
+    {
+        uint32_t value = nextRandom(rng);
+        if (value >= threshold)
+            return static_cast<int>(value % range);
+    }
+}
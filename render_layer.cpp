@@ -0,0 +1,52 @@
+#include "render_layer.h"
+// namespaces
+using namespace std;
+using namespace sf;
+
+bool createLayer(RenderLayer& layer, int x, int y, unsigned width, unsigned height)
+{
+    if (!layer.texture.create(width, height))
+        return false;
+    // window coordinates map onto the texture, so the usual positions work when drawing into it
+    layer.texture.setView(View(FloatRect(static_cast<float>(x), static_cast<float>(y), static_cast<float>(width),
+                                         static_cast<float>(height))));
+    layer.sprite.setTexture(layer.texture.getTexture(), true);
+    layer.sprite.setPosition(static_cast<float>(x), static_cast<float>(y));
+    layer.valid = false;
+    layer.opaque = true;
+    for (int i = 0; i < LAYER_VALUES; i++)
+    {
+        layer.shown[i] = 0;
+    }
+    return true;
+}
+void invalidateLayer(RenderLayer& layer)
+{
+    layer.valid = false;
+}
+void trackLayerValue(RenderLayer& layer, int slot, int value)
+{
+    if (layer.shown[slot] != value)
+    {
+        layer.shown[slot] = value;
+        layer.valid = false;
+    }
+}
+bool beginLayer(RenderLayer& layer, const Color& background)
+{
+    if (layer.valid)
+        return false;
+    layer.texture.clear(background);
+    layer.opaque = background.a == 255;
+    return true;
+}
+void endLayer(RenderLayer& layer)
+{
+    layer.texture.display();
+    layer.valid = true;
+}
+void drawLayer(RenderTarget& target, const RenderLayer& layer)
+{
+    // what was drawn into a transparent texture is already multiplied by its alpha
+    target.draw(layer.sprite, layer.opaque ? BlendNone : BlendMode(BlendMode::One, BlendMode::OneMinusSrcAlpha));
+}
@@ -0,0 +1,32 @@
+#pragma once
+// Cached screen layers: parts of the screen that rarely change (backgrounds, titles, the sidebar
+// HUD) are drawn once into an sf::RenderTexture and then put on screen as a single quad a frame.
+// A layer is drawn again only once it is invalidated, by hand or because a value it shows changed.
+// An opaque layer (cleared to a solid color) replaces what is under it without blending, which is
+// most of the cost of a fill on a software renderer. A transparent one (cleared to Color::Transparent)
+// holds premultiplied colors and is blended as such, so it looks the same as drawing its contents
+// straight onto the window at that point.
+#include <SFML/Graphics.hpp>
+
+const int LAYER_VALUES = 8; // values a layer can watch (see trackLayerValue)
+
+struct RenderLayer
+{
+    sf::RenderTexture texture;
+    sf::Sprite sprite;        // the texture at the layer's place on screen
+    bool valid;               // texture matches what the layer should show
+    bool opaque;              // cleared to a solid color, nothing under it shows through
+    int shown[LAYER_VALUES];  // watched values as of the last render
+};
+
+// A layer covering (x, y, width, height) of the window. Drawing into it uses window coordinates
+bool createLayer(RenderLayer& layer, int x, int y, unsigned width, unsigned height);
+void invalidateLayer(RenderLayer& layer);
+// Invalidates the layer when the value it shows in `slot` is no longer `value`
+void trackLayerValue(RenderLayer& layer, int slot, int value);
+// True when the layer has to be drawn again: it is cleared to `background`, draw into layer.texture
+// and then call endLayer
+bool beginLayer(RenderLayer& layer, const sf::Color& background);
+void endLayer(RenderLayer& layer);
+// One quad, written over what is under it (opaque) or blended onto it (transparent)
+void drawLayer(sf::RenderTarget& target, const RenderLayer& layer);
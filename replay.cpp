@@ -0,0 +1,214 @@
+#include "replay.h"
+// C++ libraries
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <climits>
+// namespaces
+using namespace std;
+
+const char REPLAY_MAGIC[4] = {'S', 'S', 'R', 'P'};
+
+// LEB128: 7 bits per byte, high bit set while more bytes follow
+void writeVarint(vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+bool readVarint(const vector<uint8_t>& in, size_t& offset, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && offset < in.size(); shift += 7)
+    {
+        uint8_t byte = in[offset++];
+        if (shift == 63 && byte > 1) // more than 64 bits
+            return false;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false; // truncated or corrupt
+}
+unsigned inputBits(const SimInput& input)
+{
+    return (input.left ? REPLAY_LEFT : 0) | (input.right ? REPLAY_RIGHT : 0) | (input.fire ? REPLAY_FIRE : 0);
+}
+// Write out the run being recorded
+void flushRun(Replay& replay)
+{
+    if (replay.runLength > 0)
+        writeVarint(replay.records, (replay.runLength << 4) | (replay.runBits << 1));
+    replay.runLength = 0;
+}
+
+void startRecording(Replay& replay, uint64_t seed, int lives, int score, int level)
+{
+    replay = Replay();
+    replay.seed = seed;
+    replay.startLives = lives;
+    replay.startScore = score;
+    replay.startLevel = level;
+}
+void recordTicks(Replay& replay, const SimInput& input, int ticks)
+{
+    if (ticks <= 0 || replay.finished)
+        return;
+    unsigned bits = inputBits(input);
+    if (bits != replay.runBits)
+    {
+        flushRun(replay);
+        replay.runBits = bits;
+    }
+    replay.runLength += ticks;
+    replay.ticks += ticks;
+}
+void recordCommand(Replay& replay, int command)
+{
+    if (replay.finished)
+        return;
+    flushRun(replay);
+    writeVarint(replay.records, (static_cast<uint64_t>(command) << 1) | 1);
+}
+void finishRecording(Replay& replay, const GameSim& sim)
+{
+    if (replay.finished)
+        return;
+    recordCommand(replay, REPLAY_END);
+    replay.endScore = sim.score;
+    replay.endKills = sim.killCount;
+    replay.endLevel = sim.level;
+    writeVarint(replay.records, static_cast<uint64_t>(replay.endScore));
+    writeVarint(replay.records, static_cast<uint64_t>(replay.endKills));
+    writeVarint(replay.records, static_cast<uint64_t>(replay.endLevel));
+    writeVarint(replay.records, static_cast<uint64_t>(replay.ticks));
+    replay.finished = true;
+}
+vector<uint8_t> encodeReplay(const Replay& replay)
+{
+    vector<uint8_t> bytes(REPLAY_MAGIC, REPLAY_MAGIC + 4);
+    bytes.push_back(REPLAY_VERSION);
+    writeVarint(bytes, replay.seed);
+    writeVarint(bytes, static_cast<uint64_t>(replay.startLives));
+    writeVarint(bytes, static_cast<uint64_t>(replay.startScore));
+    writeVarint(bytes, static_cast<uint64_t>(replay.startLevel));
+    bytes.insert(bytes.end(), replay.records.begin(), replay.records.end());
+    return bytes;
+}
+bool saveReplay(const Replay& replay, const char fileName[])
+{
+    vector<uint8_t> bytes = encodeReplay(replay);
+    ofstream outputFile(fileName, ios::binary);
+    if (!outputFile.is_open())
+        return false;
+    outputFile.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return outputFile.good();
+}
+bool loadReplay(Replay& replay, const char fileName[])
+{
+    ifstream inputFile(fileName, ios::binary);
+    if (!inputFile.is_open())
+        return false;
+    vector<uint8_t> bytes((istreambuf_iterator<char>(inputFile)), istreambuf_iterator<char>());
+    if (bytes.size() < 5 || memcmp(bytes.data(), REPLAY_MAGIC, 4) != 0 || bytes[4] != REPLAY_VERSION)
+        return false;
+    size_t offset = 5;
+    uint64_t seed, lives, score, level;
+    if (!readVarint(bytes, offset, seed) || !readVarint(bytes, offset, lives) ||
+        !readVarint(bytes, offset, score) || !readVarint(bytes, offset, level))
+        return false;
+    if (lives < 1 || lives > INT_MAX || score > INT_MAX || level < 1 || level > MAX_LEVEL) // no game starts like that
+        return false;
+    replay = Replay();
+    replay.seed = seed;
+    replay.startLives = static_cast<int>(lives);
+    replay.startScore = static_cast<int>(score);
+    replay.startLevel = static_cast<int>(level);
+    replay.records.assign(bytes.begin() + offset, bytes.end());
+    // Walk the records once to find the end record and check nothing is cut off
+    size_t at = 0;
+    uint64_t record;
+    while (at < replay.records.size())
+    {
+        if (!readVarint(replay.records, at, record))
+            return false;
+        if (!(record & 1))
+        {
+            replay.ticks += static_cast<long>(record >> 4);
+        }
+        else if ((record >> 1) == REPLAY_END)
+        {
+            uint64_t endScore, endKills, endLevel, ticks;
+            if (!readVarint(replay.records, at, endScore) || !readVarint(replay.records, at, endKills) ||
+                !readVarint(replay.records, at, endLevel) || !readVarint(replay.records, at, ticks))
+                return false;
+            replay.endScore = static_cast<int>(endScore);
+            replay.endKills = static_cast<int>(endKills);
+            replay.endLevel = static_cast<int>(endLevel);
+            replay.finished = true;
+            break;
+        }
+    }
+    return true;
+}
+
+void startPlayback(GameSim& sim, const Replay& replay, ReplayCursor& cursor)
+{
+    cursor = ReplayCursor();
+    sim.setSeed(replay.seed);
+    sim.newGame(replay.startLives, replay.startScore, replay.startLevel);
+}
+bool nextReplayTick(GameSim& sim, const Replay& replay, ReplayCursor& cursor, SimInput& input)
+{
+    uint64_t record;
+    while (cursor.remaining == 0)
+    {
+        if (!readVarint(replay.records, cursor.offset, record))
+            return false; // ran out (a session cut short has no end record)
+        if (!(record & 1))
+        {
+            cursor.bits = static_cast<unsigned>(record >> 1) & 7u;
+            cursor.remaining = record >> 4;
+            continue;
+        }
+        int command = static_cast<int>(record >> 1);
+        if (command == REPLAY_END)
+        {
+            cursor.offset = replay.records.size();
+            return false;
+        }
+        if (command == REPLAY_RESTART_TIMERS)
+            sim.restartTimers();
+        else if (command == REPLAY_RESTART_LEVEL)
+            sim.restartLevel();
+        // pause / resume don't change the rules, they are only there to show where the player stopped
+    }
+    cursor.remaining--;
+    input.left = (cursor.bits & REPLAY_LEFT) != 0;
+    input.right = (cursor.bits & REPLAY_RIGHT) != 0;
+    input.fire = (cursor.bits & REPLAY_FIRE) != 0;
+    return true;
+}
+int stepReplay(GameSim& sim, const Replay& replay, ReplayCursor& cursor, float dt)
+{
+    // GameSim::step(), only the input changes from tick to tick
+    return sim.stepWith(
+        dt, [&](SimInput& input) { return nextReplayTick(sim, replay, cursor, input); }, [] {});
+}
+long playReplay(GameSim& sim, const Replay& replay)
+{
+    ReplayCursor cursor;
+    startPlayback(sim, replay, cursor);
+    long ticks = 0;
+    SimInput input;
+    while (nextReplayTick(sim, replay, cursor, input))
+    {
+        sim.beginStep(0.0f); // one tick per step, its outputs only
+        sim.tick(input);
+        ticks++;
+    }
+    return ticks;
+}
@@ -0,0 +1,71 @@
+#pragma once
+// Input recording and replay: a session is its seed, the state it started from and the input of
+// every tick, so playing the inputs back on a sim seeded the same way ends in the same game.
+//
+// File layout (every number is a LEB128 varint, so small values take one byte):
+//   "SSRP" version seed lives score level
+//   records...
+//   end-record score kills level ticks      (how the session ended, to check a playback against)
+// A record is (length << 4) | (input bits << 1) for `length` ticks held with the same input,
+// or (command << 1) | 1 for something the front end did between ticks. Held keys make long runs,
+// so a session costs a few bytes per key change.
+#include "game_sim.h"
+#include <cstdint>
+#include <vector>
+
+const uint8_t REPLAY_VERSION = 1;
+// Input bits
+const unsigned REPLAY_LEFT = 1u << 0;
+const unsigned REPLAY_RIGHT = 1u << 1;
+const unsigned REPLAY_FIRE = 1u << 2;
+// Commands
+const int REPLAY_PAUSE = 0;
+const int REPLAY_RESUME = 1;
+const int REPLAY_RESTART_TIMERS = 2; // back from the level up screen
+const int REPLAY_RESTART_LEVEL = 3;  // pause menu "Restart"
+const int REPLAY_END = 4;
+
+struct Replay
+{
+    uint64_t seed = 0;
+    int startLives = 0;
+    int startScore = 0;
+    int startLevel = 0;
+    std::vector<uint8_t> records; // encoded records, without the header
+    // Run still being recorded
+    unsigned runBits = 0;
+    uint64_t runLength = 0;
+    long ticks = 0;
+    bool finished = false;
+    // How the session ended (valid once finished)
+    int endScore = 0;
+    int endKills = 0;
+    int endLevel = 0;
+};
+
+// Reading position in a replay
+struct ReplayCursor
+{
+    size_t offset = 0;
+    unsigned bits = 0;
+    uint64_t remaining = 0; // ticks left in the current run
+};
+
+// Recording
+void startRecording(Replay& replay, uint64_t seed, int lives, int score, int level);
+void recordTicks(Replay& replay, const SimInput& input, int ticks);
+void recordCommand(Replay& replay, int command);
+void finishRecording(Replay& replay, const GameSim& sim);
+std::vector<uint8_t> encodeReplay(const Replay& replay); // the file's bytes, header included
+bool saveReplay(const Replay& replay, const char fileName[]);
+bool loadReplay(Replay& replay, const char fileName[]);
+
+// Playback: seed and start the sim the way the recording did
+void startPlayback(GameSim& sim, const Replay& replay, ReplayCursor& cursor);
+// Input for the next tick, after applying any commands recorded before it. False at the end
+bool nextReplayTick(GameSim& sim, const Replay& replay, ReplayCursor& cursor, SimInput& input);
+// GameSim::step() fed from the replay instead of one input (window playback).
+// Returns STATE_MENU once the replay has run out
+int stepReplay(GameSim& sim, const Replay& replay, ReplayCursor& cursor, float dt);
+// The whole replay as fast as possible, returns the number of ticks run
+long playReplay(GameSim& sim, const Replay& replay);
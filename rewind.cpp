@@ -0,0 +1,193 @@
+#include "rewind.h"
+// C++ libraries
+#include <cstring>
+// namespaces
+using namespace std;
+
+// Longest possible delta: every word changed, one run
+const size_t REWIND_MAX_DELTA_BYTES = REWIND_SNAPSHOT_WORDS * 4 + 8;
+
+uint8_t* writeRunLength(uint8_t* out, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        *out++ = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+const uint8_t* readRunLength(const uint8_t* in, uint32_t& value)
+{
+    value = 0;
+    int shift = 0;
+    while (*in & 0x80)
+    {
+        value |= static_cast<uint32_t>(*in++ & 0x7f) << shift;
+        shift += 7;
+    }
+    value |= static_cast<uint32_t>(*in++) << shift;
+    return in;
+}
+uint32_t loadWord(const uint8_t* bytes, int word)
+{
+    uint32_t value;
+    memcpy(&value, bytes + word * 4, 4);
+    return value;
+}
+// `to` XOR `from` as (unchanged words to skip, changed words, their XOR) runs. Returns the end
+uint8_t* encodeDelta(const SimSnapshot& from, const SimSnapshot& to, uint8_t* out)
+{
+    const uint8_t* a = reinterpret_cast<const uint8_t*>(&from);
+    const uint8_t* b = reinterpret_cast<const uint8_t*>(&to);
+    int word = 0;
+    while (word < REWIND_SNAPSHOT_WORDS)
+    {
+        int start = word;
+        // most of a snapshot is unchanged, skip it two words at a time
+        while (word + 2 <= REWIND_SNAPSHOT_WORDS && memcmp(a + word * 4, b + word * 4, 8) == 0)
+            word += 2;
+        while (word < REWIND_SNAPSHOT_WORDS && loadWord(a, word) == loadWord(b, word))
+            word++;
+        if (word == REWIND_SNAPSHOT_WORDS)
+            break;
+        int skip = word - start;
+        start = word;
+        while (word < REWIND_SNAPSHOT_WORDS && loadWord(a, word) != loadWord(b, word))
+            word++;
+        out = writeRunLength(out, static_cast<uint32_t>(skip));
+        out = writeRunLength(out, static_cast<uint32_t>(word - start));
+        for (int i = start; i < word; i++)
+        {
+            uint32_t change = loadWord(a, i) ^ loadWord(b, i);
+            memcpy(out, &change, 4);
+            out += 4;
+        }
+    }
+    return out;
+}
+// One tick forward or back, whichever side of the delta `snapshot` is on
+void applyDelta(SimSnapshot& snapshot, const uint8_t* in, const uint8_t* end)
+{
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(&snapshot);
+    int word = 0;
+    while (in < end)
+    {
+        uint32_t skip, count;
+        in = readRunLength(in, skip);
+        in = readRunLength(in, count);
+        word += static_cast<int>(skip);
+        for (uint32_t i = 0; i < count; i++, word++)
+        {
+            uint32_t value = loadWord(bytes, word);
+            uint32_t change;
+            memcpy(&change, in, 4);
+            in += 4;
+            value ^= change;
+            memcpy(bytes + word * 4, &value, 4);
+        }
+    }
+}
+uint32_t deltaStart(const RewindGroup& group, int tick)
+{
+    return tick > 1 ? group.deltaEnd[tick - 1] : 0;
+}
+
+void initRewind(RewindBuffer& rewind)
+{
+    rewind.groups.resize(REWIND_GROUPS);
+    clearRewind(rewind);
+}
+void clearRewind(RewindBuffer& rewind)
+{
+    rewind.firstGroup = 0;
+    rewind.groupCount = 0;
+    rewind.ticks = 0;
+}
+void recordRewind(RewindBuffer& rewind, const GameSim& sim)
+{
+    captureSnapshot(sim, rewind.captured);
+    RewindGroup* group = nullptr;
+    if (rewind.groupCount > 0)
+        group = &rewind.groups[(rewind.firstGroup + rewind.groupCount - 1) % REWIND_GROUPS];
+    if (group && group->ticks < REWIND_KEYFRAME_INTERVAL &&
+        deltaStart(*group, group->ticks) + REWIND_MAX_DELTA_BYTES <= REWIND_GROUP_BYTES)
+    {
+        uint8_t* start = group->deltas + deltaStart(*group, group->ticks);
+        uint8_t* end = encodeDelta(rewind.newest, rewind.captured, start);
+        group->deltaEnd[group->ticks] = static_cast<uint32_t>(end - group->deltas);
+        group->ticks++;
+    }
+    else
+    {
+        // a new group, in place of the oldest once the ring is full
+        if (rewind.groupCount == REWIND_GROUPS)
+        {
+            rewind.ticks -= rewind.groups[rewind.firstGroup].ticks;
+            rewind.firstGroup = (rewind.firstGroup + 1) % REWIND_GROUPS;
+            rewind.groupCount--;
+        }
+        group = &rewind.groups[(rewind.firstGroup + rewind.groupCount) % REWIND_GROUPS];
+        rewind.groupCount++;
+        group->keyframe = rewind.captured;
+        group->ticks = 1;
+    }
+    rewind.ticks++;
+    rewind.newest = rewind.captured;
+}
+int stepRewind(GameSim& sim, RewindBuffer& rewind, const SimInput& input, float dt)
+{
+    // GameSim::step(), recording after every tick
+    return sim.stepWith(
+        dt,
+        [&input](SimInput& next) {
+            next = input;
+            return true;
+        },
+        [&rewind, &sim] { recordRewind(rewind, sim); });
+}
+int rewindTicks(RewindBuffer& rewind, GameSim& sim, int ticks)
+{
+    int gone = 0;
+    while (gone < ticks && rewind.ticks > 1) // the oldest tick stays
+    {
+        RewindGroup& group = rewind.groups[(rewind.firstGroup + rewind.groupCount - 1) % REWIND_GROUPS];
+        if (group.ticks > 1)
+        {
+            // undo the newest delta
+            group.ticks--;
+            applyDelta(rewind.newest, group.deltas + deltaStart(group, group.ticks),
+                       group.deltas + group.deltaEnd[group.ticks]);
+        }
+        else
+        {
+            // the group is down to its keyframe: drop it and rebuild the end of the one before
+            rewind.groupCount--;
+            const RewindGroup& previous =
+                rewind.groups[(rewind.firstGroup + rewind.groupCount - 1) % REWIND_GROUPS];
+            rewind.newest = previous.keyframe;
+            for (int i = 1; i < previous.ticks; i++)
+            {
+                applyDelta(rewind.newest, previous.deltas + deltaStart(previous, i),
+                           previous.deltas + previous.deltaEnd[i]);
+            }
+        }
+        rewind.ticks--;
+        gone++;
+    }
+    if (gone > 0)
+        restoreSnapshot(sim, rewind.newest);
+    else
+        sim.beginStep(0.0f); // nothing to go back to, still no outputs from the last step
+    return gone;
+}
+size_t rewindBytes(const RewindBuffer& rewind)
+{
+    size_t bytes = 0;
+    for (int i = 0; i < rewind.groupCount; i++)
+    {
+        const RewindGroup& group = rewind.groups[(rewind.firstGroup + i) % REWIND_GROUPS];
+        bytes += sizeof(SimSnapshot) + deltaStart(group, group.ticks);
+    }
+    return bytes;
+}
@@ -0,0 +1,50 @@
+#pragma once
+// Rewind: the last REWIND_SECONDS of play, one SimSnapshot per tick, to scrub back through (practice,
+// or a look at how a life was lost).
+// Ticks come in groups of up to REWIND_KEYFRAME_INTERVAL: a full snapshot (the keyframe) and then
+// deltas, each the XOR of a tick's snapshot with the one before it, stored as runs of changed 32-bit
+// words. A tick only touches a few cells, counters and timers, so a delta is tens of bytes instead of
+// a snapshot's 1.6 KB. XOR works both ways, so the same delta steps back as well as forward.
+// Every group has a fixed byte budget and all of them are allocated once by initRewind: nothing is
+// allocated while recording, the oldest group is reused once REWIND_GROUPS are full.
+#include "snapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const int REWIND_SECONDS = 30;
+const int REWIND_KEYFRAME_INTERVAL = TICK_RATE;             // a keyframe every second of play
+const int REWIND_GROUPS = REWIND_SECONDS + 1;               // the newest is still filling up
+const size_t REWIND_GROUP_BYTES = 28 * 1024;                // deltas of one group, ~280 bytes a tick
+const int REWIND_SNAPSHOT_WORDS = sizeof(SimSnapshot) / 4;
+static_assert(sizeof(SimSnapshot) % 4 == 0, "deltas are in whole words");
+const float REWIND_SPEED = 2.0f; // seconds of play taken back per second the key is held
+
+struct RewindGroup
+{
+    SimSnapshot keyframe;
+    uint32_t deltaEnd[REWIND_KEYFRAME_INTERVAL]; // delta i (taking tick i - 1 to i) ends here, i >= 1
+    uint8_t deltas[REWIND_GROUP_BYTES];
+    int ticks;                                   // keyframe included
+};
+
+struct RewindBuffer
+{
+    std::vector<RewindGroup> groups; // ring of REWIND_GROUPS
+    int firstGroup;                  // oldest
+    int groupCount;
+    SimSnapshot newest;              // the last tick recorded, base of the next delta
+    SimSnapshot captured;            // scratch for the tick being recorded
+    long ticks;                      // ticks held, the newest included
+};
+
+void initRewind(RewindBuffer& rewind); // allocates every group
+void clearRewind(RewindBuffer& rewind); // forget everything (new game, quickload)
+// Add the sim as it is now, once after every tick
+void recordRewind(RewindBuffer& rewind, const GameSim& sim);
+// GameSim::step() that records every tick it runs (the same accumulator loop)
+int stepRewind(GameSim& sim, RewindBuffer& rewind, const SimInput& input, float dt);
+// Go back up to `ticks` ticks and put the sim there. Later ticks are dropped, play goes on from
+// there. The outputs of the last step are cleared either way. Returns how many ticks it went back
+int rewindTicks(RewindBuffer& rewind, GameSim& sim, int ticks);
+size_t rewindBytes(const RewindBuffer& rewind); // keyframes and deltas in use
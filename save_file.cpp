@@ -0,0 +1,68 @@
+#include "save_file.h"
+// C++ libraries
+#include <fstream>
+#include <cstring>
+#include <cstddef>
+// namespaces
+using namespace std;
+
+// Everything up to the checksum field is covered by it
+const size_t SAVE_CHECKED_BYTES = offsetof(SaveRecord, checksum);
+
+uint32_t crc32(const uint8_t* data, size_t size)
+{
+    // bitwise CRC-32 (IEEE), a save is 28 bytes so no table is needed
+    uint32_t crc = 0xffffffffu;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xedb88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+SaveRecord makeSaveRecord(int highScore, int lives, int score, int level)
+{
+    SaveRecord record;
+    memset(&record, 0, sizeof(record));
+    memcpy(record.magic, SAVE_MAGIC, 4);
+    record.version = SAVE_VERSION;
+    record.highScore = highScore;
+    record.lives = lives;
+    record.score = score;
+    record.level = level;
+    record.checksum = crc32(reinterpret_cast<const uint8_t*>(&record), SAVE_CHECKED_BYTES);
+    return record;
+}
+vector<uint8_t> encodeSaveRecord(const SaveRecord& record)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+    return vector<uint8_t>(bytes, bytes + sizeof(record));
+}
+bool loadSaveRecord(SaveRecord& record, const char fileName[])
+{
+    ifstream inputFile(fileName, ios::binary);
+    if (!inputFile.is_open())
+        return false;
+    SaveRecord read;
+    if (!inputFile.read(reinterpret_cast<char*>(&read), sizeof(read)))
+        return false;
+    if (memcmp(read.magic, SAVE_MAGIC, 4) != 0 || read.version != SAVE_VERSION ||
+        read.checksum != crc32(reinterpret_cast<const uint8_t*>(&read), SAVE_CHECKED_BYTES))
+        return false;
+    record = read;
+    return true;
+}
+bool loadLegacySave(SaveRecord& record, const char fileName[])
+{
+    ifstream inputFile(fileName);
+    if (!inputFile.is_open())
+        return false;
+    int highScore, lives, score, level;
+    if (!(inputFile >> highScore >> lives >> score >> level) || highScore < 0 || lives < 0 || score < 0 || level < 0)
+        return false;
+    record = makeSaveRecord(highScore, lives, score, level);
+    return true;
+}
@@ -0,0 +1,32 @@
+#pragma once
+// The save file: high score plus the game "Save & Quit" left behind.
+// One fixed size binary record with a version and a CRC-32, so a damaged or foreign file is refused
+// instead of read as numbers. Written through FileWriter (atomic, off the game thread).
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const char SAVE_MAGIC[4] = {'S', 'S', 'S', 'V'};
+const uint32_t SAVE_VERSION = 1;
+const char SAVE_FILE[] = "save.dat";
+const char LEGACY_SAVE_FILE[] = "save-file.txt"; // "highScore lives score level", read if there is no save.dat yet
+
+// Little endian on disk, like every platform the game builds for
+struct SaveRecord
+{
+    char magic[4];
+    uint32_t version;
+    int32_t highScore;
+    int32_t lives; // 0 when there is no game to continue
+    int32_t score;
+    int32_t level;
+    uint32_t checksum; // CRC-32 of every field above
+};
+
+uint32_t crc32(const uint8_t* data, size_t size);
+SaveRecord makeSaveRecord(int highScore, int lives, int score, int level); // fills in magic, version and checksum
+std::vector<uint8_t> encodeSaveRecord(const SaveRecord& record);
+// False when the file is missing, too short, another version or fails its checksum
+bool loadSaveRecord(SaveRecord& record, const char fileName[]);
+// The old text save, only accepted when all four numbers parse and make sense
+bool loadLegacySave(SaveRecord& record, const char fileName[]);
@@ -0,0 +1,116 @@
+#include "snapshot.h"
+#include "save_file.h"
+// C++ libraries
+#include <fstream>
+#include <cstring>
+#include <cstddef>
+#include <cstdio>
+// namespaces
+using namespace std;
+
+// Everything up to the checksum field is covered by it
+const size_t SNAPSHOT_CHECKED_BYTES = offsetof(SimSnapshot, checksum);
+
+void captureSnapshot(const GameSim& sim, SimSnapshot& snapshot)
+{
+    memset(&snapshot, 0, sizeof(snapshot)); // padding too, so equal games give equal bytes
+    memcpy(snapshot.magic, SNAPSHOT_MAGIC, 4);
+    snapshot.version = SNAPSHOT_VERSION;
+    // field by field, a struct copy could bring the board's padding byte along
+    memcpy(snapshot.board.words, sim.board.words, sizeof(sim.board.words));
+    memcpy(snapshot.board.rowTypes, sim.board.rowTypes, sizeof(sim.board.rowTypes));
+    snapshot.spaceshipCol = sim.spaceshipCol;
+    snapshot.lives = sim.lives;
+    snapshot.score = sim.score;
+    snapshot.killCount = sim.killCount;
+    snapshot.level = sim.level;
+    snapshot.bossMoveCounter = sim.bossMoveCounter;
+    snapshot.isInvincible = sim.isInvincible;
+    snapshot.invincibilityTicks = sim.invincibilityTicks;
+    memcpy(snapshot.shieldPowerupRow, sim.shieldPowerupRow, sizeof(sim.shieldPowerupRow));
+    memcpy(snapshot.shieldPowerupCol, sim.shieldPowerupCol, sizeof(sim.shieldPowerupCol));
+    memcpy(snapshot.shieldPowerupActive, sim.shieldPowerupActive, sizeof(sim.shieldPowerupActive));
+    memcpy(snapshot.shieldPowerupDirection, sim.shieldPowerupDirection, sizeof(sim.shieldPowerupDirection));
+    snapshot.hasShield = sim.hasShield;
+    snapshot.hitEffects = sim.hitEffects;
+    snapshot.moveTicks = sim.moveTicks;
+    snapshot.bulletFireTicks = sim.bulletFireTicks;
+    snapshot.meteorSpawnTicks = sim.meteorSpawnTicks;
+    snapshot.meteorMoveTicks = sim.meteorMoveTicks;
+    snapshot.enemySpawnTicks = sim.enemySpawnTicks;
+    snapshot.enemyMoveTicks = sim.enemyMoveTicks;
+    snapshot.bossSpawnTicks = sim.bossSpawnTicks;
+    snapshot.bossMoveTicks = sim.bossMoveTicks;
+    snapshot.bossBulletMoveTicks = sim.bossBulletMoveTicks;
+    snapshot.bulletMoveTicks = sim.bulletMoveTicks;
+    snapshot.shieldPowerupSpawnTicks = sim.shieldPowerupSpawnTicks;
+    snapshot.shieldPowerupMoveTicks = sim.shieldPowerupMoveTicks;
+    snapshot.nextSpawnTicks = sim.nextSpawnTicks;
+    snapshot.nextEnemySpawnTicks = sim.nextEnemySpawnTicks;
+    snapshot.nextBossSpawnTicks = sim.nextBossSpawnTicks;
+    snapshot.nextShieldPowerupSpawnTicks = sim.nextShieldPowerupSpawnTicks;
+    snapshot.seed = sim.seed;
+    memcpy(snapshot.rng, sim.rng, sizeof(sim.rng));
+    snapshot.tickAccumulator = sim.tickAccumulator;
+}
+void restoreSnapshot(GameSim& sim, const SimSnapshot& snapshot)
+{
+    sim.board = snapshot.board;
+    sim.spaceshipCol = snapshot.spaceshipCol;
+    sim.lives = snapshot.lives;
+    sim.score = snapshot.score;
+    sim.killCount = snapshot.killCount;
+    sim.level = snapshot.level;
+    sim.bossMoveCounter = snapshot.bossMoveCounter;
+    sim.isInvincible = snapshot.isInvincible;
+    sim.invincibilityTicks = snapshot.invincibilityTicks;
+    memcpy(sim.shieldPowerupRow, snapshot.shieldPowerupRow, sizeof(sim.shieldPowerupRow));
+    memcpy(sim.shieldPowerupCol, snapshot.shieldPowerupCol, sizeof(sim.shieldPowerupCol));
+    memcpy(sim.shieldPowerupActive, snapshot.shieldPowerupActive, sizeof(sim.shieldPowerupActive));
+    memcpy(sim.shieldPowerupDirection, snapshot.shieldPowerupDirection, sizeof(sim.shieldPowerupDirection));
+    sim.hasShield = snapshot.hasShield;
+    sim.hitEffects = snapshot.hitEffects;
+    sim.moveTicks = snapshot.moveTicks;
+    sim.bulletFireTicks = snapshot.bulletFireTicks;
+    sim.meteorSpawnTicks = snapshot.meteorSpawnTicks;
+    sim.meteorMoveTicks = snapshot.meteorMoveTicks;
+    sim.enemySpawnTicks = snapshot.enemySpawnTicks;
+    sim.enemyMoveTicks = snapshot.enemyMoveTicks;
+    sim.bossSpawnTicks = snapshot.bossSpawnTicks;
+    sim.bossMoveTicks = snapshot.bossMoveTicks;
+    sim.bossBulletMoveTicks = snapshot.bossBulletMoveTicks;
+    sim.bulletMoveTicks = snapshot.bulletMoveTicks;
+    sim.shieldPowerupSpawnTicks = snapshot.shieldPowerupSpawnTicks;
+    sim.shieldPowerupMoveTicks = snapshot.shieldPowerupMoveTicks;
+    sim.nextSpawnTicks = snapshot.nextSpawnTicks;
+    sim.nextEnemySpawnTicks = snapshot.nextEnemySpawnTicks;
+    sim.nextBossSpawnTicks = snapshot.nextBossSpawnTicks;
+    sim.nextShieldPowerupSpawnTicks = snapshot.nextShieldPowerupSpawnTicks;
+    sim.seed = snapshot.seed;
+    memcpy(sim.rng, snapshot.rng, sizeof(sim.rng));
+    sim.tickAccumulator = snapshot.tickAccumulator;
+    // events queued before the restore belong to the game that was left, clear() keeps the capacity
+    sim.gameEvents.clear();
+    sim.beginStep(0.0f);
+}
+vector<uint8_t> encodeSnapshot(const SimSnapshot& snapshot)
+{
+    SimSnapshot sealed = snapshot;
+    sealed.checksum = crc32(reinterpret_cast<const uint8_t*>(&sealed), SNAPSHOT_CHECKED_BYTES);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&sealed);
+    return vector<uint8_t>(bytes, bytes + sizeof(sealed));
+}
+bool loadSnapshot(SimSnapshot& snapshot, const char fileName[])
+{
+    ifstream inputFile(fileName, ios::binary);
+    if (!inputFile.is_open())
+        return false;
+    SimSnapshot read;
+    if (!inputFile.read(reinterpret_cast<char*>(&read), sizeof(read)) || inputFile.peek() != EOF) // another build's size
+        return false;
+    if (memcmp(read.magic, SNAPSHOT_MAGIC, 4) != 0 || read.version != SNAPSHOT_VERSION ||
+        read.checksum != crc32(reinterpret_cast<const uint8_t*>(&read), SNAPSHOT_CHECKED_BYTES))
+        return false;
+    snapshot = read;
+    return true;
+}
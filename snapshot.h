@@ -0,0 +1,64 @@
+#pragma once
+// Whole-game snapshots of a GameSim: the board and every counter, timer and random stream the rules
+// read, in one trivially copyable struct. Capturing or restoring one copies about 1.5 KB and never
+// allocates, so quicksave / quickload is instant. The file form adds a magic, a version and a
+// CRC-32 and is written through FileWriter; it only has to be read back by the same build.
+// Only the classic board: a DynamicBoard keeps its cells in vectors.
+#include "game_sim.h"
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+const char SNAPSHOT_MAGIC[4] = {'S', 'S', 'S', 'N'};
+const uint32_t SNAPSHOT_VERSION = 2;
+const char QUICKSAVE_FILE[] = "quicksave.snap"; // F5 / F9, and the full state behind "Load Saved Game"
+
+struct SimSnapshot
+{
+    char magic[4];
+    uint32_t version;
+    ClassicBoard board;
+    int spaceshipCol;
+    int lives;
+    int score;
+    int killCount;
+    int level;
+    int bossMoveCounter;
+    bool isInvincible;
+    int invincibilityTicks;
+    int shieldPowerupRow[MAX_SHIELD_POWERUPS];
+    int shieldPowerupCol[MAX_SHIELD_POWERUPS];
+    bool shieldPowerupActive[MAX_SHIELD_POWERUPS];
+    int shieldPowerupDirection[MAX_SHIELD_POWERUPS];
+    bool hasShield;
+    HitEffectPool hitEffects;
+    int moveTicks;
+    int bulletFireTicks;
+    int meteorSpawnTicks;
+    int meteorMoveTicks;
+    int enemySpawnTicks;
+    int enemyMoveTicks;
+    int bossSpawnTicks;
+    int bossMoveTicks;
+    int bossBulletMoveTicks;
+    int bulletMoveTicks;
+    int shieldPowerupSpawnTicks;
+    int shieldPowerupMoveTicks;
+    int nextSpawnTicks;
+    int nextEnemySpawnTicks;
+    int nextBossSpawnTicks;
+    int nextShieldPowerupSpawnTicks;
+    uint64_t seed;
+    Pcg32 rng[RNG_STREAMS];
+    float tickAccumulator;
+    uint32_t saveChecksum; // Save & Quit: checksum of the SaveRecord written with it, 0 for a quicksave
+    uint32_t checksum; // CRC-32 of everything above, set for the file copy
+};
+static_assert(std::is_trivially_copyable<SimSnapshot>::value, "snapshots are copied as bytes");
+
+void captureSnapshot(const GameSim& sim, SimSnapshot& snapshot);
+// Puts the game back exactly as captured (pending events and the last step's output are dropped)
+void restoreSnapshot(GameSim& sim, const SimSnapshot& snapshot);
+std::vector<uint8_t> encodeSnapshot(const SimSnapshot& snapshot); // with the checksum, for FileWriter
+// False when the file is missing, another version or build, or fails its checksum
+bool loadSnapshot(SimSnapshot& snapshot, const char fileName[]);
@@ -0,0 +1,88 @@
+#include "sound_pool.h"
+// C++ libraries
+#include <algorithm>
+// namespaces
+using namespace std;
+using namespace sf;
+
+SoundPool::SoundPool()
+{
+    for (int v = 0; v < VOICE_COUNT; v++)
+    {
+        voiceEffect[v] = -1;
+        voiceStarted[v] = 0;
+    }
+    playCounter = 0;
+}
+int SoundPool::addEffect(const SoundBuffer& buffer, int priority, int maxVoices)
+{
+    SoundEffect effect = {&buffer, priority, max(1, min(maxVoices, VOICE_COUNT)), 0};
+    effects.push_back(effect);
+    int id = static_cast<int>(effects.size()) - 1;
+    // after every effect of the same priority, so equal ones keep the order they were added in
+    auto at = upper_bound(byPriority.begin(), byPriority.end(), priority,
+                          [this](int p, int e) { return p > effects[e].priority; });
+    byPriority.insert(at, id);
+    return id;
+}
+void SoundPool::request(int effect, int count)
+{
+    effects[effect].pending += count;
+}
+// Voice for a new sound of `effect`, or -1 to drop it
+int SoundPool::pickVoice(int effect)
+{
+    int playing = 0;
+    int oldestOwn = -1;
+    int freeVoice = -1;
+    int oldestStealable = -1;
+    for (int v = 0; v < VOICE_COUNT; v++)
+    {
+        if (voiceEffect[v] < 0 || voices[v].getStatus() == Sound::Stopped)
+        {
+            if (freeVoice < 0)
+                freeVoice = v;
+            continue;
+        }
+        if (voiceEffect[v] == effect)
+        {
+            playing++;
+            if (oldestOwn < 0 || voiceStarted[v] < voiceStarted[oldestOwn])
+                oldestOwn = v;
+        }
+        if (effects[voiceEffect[v]].priority <= effects[effect].priority &&
+            (oldestStealable < 0 || voiceStarted[v] < voiceStarted[oldestStealable]))
+            oldestStealable = v;
+    }
+    if (playing >= effects[effect].maxVoices) // at its limit: restart its own oldest voice
+        return oldestOwn;
+    if (freeVoice >= 0)
+        return freeVoice;
+    return oldestStealable;
+}
+void SoundPool::flush()
+{
+    // most important effects pick voices first
+    for (int effect : byPriority)
+    {
+        if (effects[effect].pending == 0)
+            continue;
+        // more hits of one effect in a frame than it has voices would only restart each other
+        int starts = min(effects[effect].pending, effects[effect].maxVoices);
+        effects[effect].pending = 0;
+        for (int i = 0; i < starts; i++)
+        {
+            int v = pickVoice(effect);
+            if (v < 0)
+                break; // everything is busy with more important sounds
+            if (voiceEffect[v] != effect)
+            {
+                voices[v].stop();
+                voices[v].setBuffer(*effects[effect].buffer);
+                voiceEffect[v] = effect;
+            }
+            voices[v].play(); // restarts it if it was playing
+            voiceStarted[v] = ++playCounter;
+        }
+    }
+}
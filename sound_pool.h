@@ -0,0 +1,41 @@
+#pragma once
+// Sound effect voices: a fixed set of sf::Sound voices shared by every effect.
+// Gameplay and menus only queue requests, flush() plays them once per frame, so a frame never
+// starts more than VOICE_COUNT sounds however many collisions it had.
+// Each effect has a priority and a limit on how many voices it may hold at once. A new sound takes
+// a free voice, or steals the oldest voice of its own effect once at the limit, or the oldest voice
+// of an effect with the same or lower priority. If every voice is busy with something more
+// important the request is dropped.
+#include <SFML/Audio.hpp>
+// C++ libraries
+#include <vector>
+
+const int VOICE_COUNT = 16;
+
+struct SoundEffect
+{
+    const sf::SoundBuffer* buffer;
+    int priority;  // higher wins when voices run out
+    int maxVoices; // voices this effect may play on at once
+    int pending;   // requests queued since the last flush
+};
+
+class SoundPool
+{
+public:
+    SoundPool();
+    // Returns the effect id to request it with
+    int addEffect(const sf::SoundBuffer& buffer, int priority, int maxVoices);
+    void request(int effect, int count = 1);
+    void flush(); // once per frame
+
+private:
+    std::vector<SoundEffect> effects;
+    std::vector<int> byPriority; // effect ids, most important first, kept in order as effects are added
+    sf::Sound voices[VOICE_COUNT];
+    int voiceEffect[VOICE_COUNT];       // effect on each voice, -1 if it never played
+    unsigned voiceStarted[VOICE_COUNT]; // play order, to find the oldest voice
+    unsigned playCounter;
+
+    int pickVoice(int effect);
+};
@@ -0,0 +1,146 @@
+// Build-time asset archive packer
+// Packs every asset the game loads into one archive (see asset_archive.h) so the game opens a
+// single file at startup. After --decoded, images are stored as raw RGBA and sounds as 16-bit PCM,
+// so the game skips PNG / MP3 decoding too. --encoded switches back to storing files as they are
+// (worth it for music, which streams and would be huge as PCM).
+//
+// Usage: asset_packer <out.pak> [--decoded | --encoded] name=file [name=file ...]
+// SFML libraries
+#include <SFML/Graphics.hpp>
+#include <SFML/Audio.hpp>
+// C++ libraries
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <cstring>
+// Archive format
+#include "asset_archive.h"
+// namespaces
+using namespace std;
+using namespace sf;
+
+struct PackedEntry
+{
+    ArchiveEntry entry;
+    vector<uint8_t> data;
+};
+
+bool hasExtension(const string& file, const char extension[])
+{
+    size_t length = strlen(extension);
+    return file.size() >= length && file.compare(file.size() - length, length, extension) == 0;
+}
+bool readFile(const string& file, vector<uint8_t>& data)
+{
+    ifstream inputFile(file, ios::binary);
+    if (!inputFile.is_open())
+        return false;
+    data.assign(istreambuf_iterator<char>(inputFile), istreambuf_iterator<char>());
+    return true;
+}
+// Raw pixels / samples for images and sounds, the file itself for anything else
+bool packEntry(PackedEntry& packed, const string& file, bool decoded)
+{
+    if (decoded && hasExtension(file, ".png"))
+    {
+        Image image;
+        if (!image.loadFromFile(file))
+            return false;
+        packed.entry.kind = ENTRY_RGBA;
+        packed.entry.width = image.getSize().x;
+        packed.entry.height = image.getSize().y;
+        const uint8_t* pixels = image.getPixelsPtr();
+        packed.data.assign(pixels, pixels + static_cast<size_t>(packed.entry.width) * packed.entry.height * 4);
+        return true;
+    }
+    if (decoded && (hasExtension(file, ".wav") || hasExtension(file, ".mp3") || hasExtension(file, ".ogg")))
+    {
+        SoundBuffer buffer;
+        if (!buffer.loadFromFile(file))
+            return false;
+        packed.entry.kind = ENTRY_PCM;
+        packed.entry.channels = buffer.getChannelCount();
+        packed.entry.sampleRate = buffer.getSampleRate();
+        const uint8_t* samples = reinterpret_cast<const uint8_t*>(buffer.getSamples());
+        packed.data.assign(samples, samples + buffer.getSampleCount() * sizeof(Int16));
+        return true;
+    }
+    packed.entry.kind = ENTRY_FILE;
+    return readFile(file, packed.data);
+}
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        cerr << "Usage: asset_packer <out.pak> [--decoded | --encoded] name=file ..." << endl;
+        return 1;
+    }
+    vector<PackedEntry> entries;
+    bool decoded = false;
+    for (int i = 2; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--decoded" || arg == "--encoded")
+        {
+            decoded = arg == "--decoded";
+            continue;
+        }
+        size_t eq = arg.find('=');
+        if (eq == string::npos || eq >= static_cast<size_t>(ARCHIVE_NAME_LENGTH))
+        {
+            cerr << "Expected name=file with a name under " << ARCHIVE_NAME_LENGTH << " characters, got " << arg << endl;
+            return 1;
+        }
+        PackedEntry packed;
+        memset(&packed.entry, 0, sizeof(packed.entry));
+        memcpy(packed.entry.name, arg.data(), eq);
+        if (!packEntry(packed, arg.substr(eq + 1), decoded))
+        {
+            cerr << "Failed to load " << arg.substr(eq + 1) << endl;
+            return 1;
+        }
+        entries.push_back(packed);
+    }
+    // index first, then the data of every entry, aligned
+    uint64_t offset = sizeof(ArchiveHeader) + entries.size() * sizeof(ArchiveEntry);
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        offset = (offset + ARCHIVE_ALIGNMENT - 1) / ARCHIVE_ALIGNMENT * ARCHIVE_ALIGNMENT;
+        entries[i].entry.offset = offset;
+        entries[i].entry.size = entries[i].data.size();
+        offset += entries[i].data.size();
+    }
+    ofstream outputFile(argv[1], ios::binary);
+    if (!outputFile.is_open())
+    {
+        cerr << "Failed to write " << argv[1] << endl;
+        return 1;
+    }
+    ArchiveHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ARCHIVE_MAGIC, 4);
+    header.version = ARCHIVE_VERSION;
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    outputFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        outputFile.write(reinterpret_cast<const char*>(&entries[i].entry), sizeof(ArchiveEntry));
+    }
+    uint64_t written = sizeof(ArchiveHeader) + entries.size() * sizeof(ArchiveEntry);
+    const char padding[ARCHIVE_ALIGNMENT] = {};
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        outputFile.write(padding, static_cast<streamsize>(entries[i].entry.offset - written));
+        outputFile.write(reinterpret_cast<const char*>(entries[i].data.data()), entries[i].data.size());
+        written = entries[i].entry.offset + entries[i].data.size();
+    }
+    if (!outputFile.good())
+    {
+        cerr << "Failed to write " << argv[1] << endl;
+        return 1;
+    }
+    cout << "Packed " << entries.size() << " assets into " << argv[1] << " (" << written / 1024 << " KiB)" << endl;
+    return 0;
+}
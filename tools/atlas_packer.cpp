@@ -0,0 +1,138 @@
+// Build-time texture atlas packer
+// Packs every sprite image into one PNG and writes a header with each sprite's rectangle in it,
+// so the game loads a single texture at startup instead of one file per sprite.
+//
+// Usage: atlas_packer <atlas.png> <atlas_rects.h> <image dir> NAME=file.png [NAME=file.png ...]
+// The sprites get ids SPRITE_<NAME> in the order they are given.
+// SFML libraries
+#include <SFML/Graphics.hpp>
+// C++ libraries
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+// namespaces
+using namespace std;
+using namespace sf;
+
+const int ATLAS_WIDTH = 512;  // sprites are packed in shelves of this width
+const int ATLAS_PADDING = 2;  // empty pixels between sprites so they never bleed into each other
+
+struct PackedSprite
+{
+    string name;
+    string file;
+    Image image;
+    IntRect rect;
+};
+
+// Shelf packing: tallest sprites first, left to right, new shelf when the row is full.
+// Returns the height of the atlas.
+int packShelves(vector<PackedSprite>& sprites)
+{
+    vector<int> order(sprites.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = static_cast<int>(i);
+    stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return sprites[a].image.getSize().y > sprites[b].image.getSize().y;
+    });
+    int x = 0;
+    int y = 0;
+    int shelfHeight = 0;
+    for (int i : order)
+    {
+        int w = sprites[i].image.getSize().x;
+        int h = sprites[i].image.getSize().y;
+        if (x > 0 && x + w > ATLAS_WIDTH)
+        {
+            x = 0;
+            y += shelfHeight + ATLAS_PADDING;
+            shelfHeight = 0;
+        }
+        sprites[i].rect = IntRect(x, y, w, h);
+        x += w + ATLAS_PADDING;
+        if (h > shelfHeight)
+            shelfHeight = h;
+    }
+    return y + shelfHeight;
+}
+bool writeHeader(const char path[], const vector<PackedSprite>& sprites, const string& atlasFile)
+{
+    ofstream header(path);
+    if (!header.is_open())
+    {
+        cerr << "Failed to write " << path << endl;
+        return false;
+    }
+    header << "// Generated by atlas_packer, do not edit\n";
+    header << "#pragma once\n";
+    header << "// Sprite ids\n";
+    for (size_t i = 0; i < sprites.size(); i++)
+    {
+        header << "const int SPRITE_" << sprites[i].name << " = " << i << ";\n";
+    }
+    header << "const int SPRITE_COUNT = " << sprites.size() << ";\n";
+    header << "// Atlas image, by its name in assets.pak\n";
+    header << "const char ATLAS_FILE[] = \"" << atlasFile << "\";\n";
+    header << "// Where each sprite sits in the atlas: left, top, width, height (pixels)\n";
+    header << "const int ATLAS_RECTS[SPRITE_COUNT][4] = {\n";
+    for (size_t i = 0; i < sprites.size(); i++)
+    {
+        const IntRect& r = sprites[i].rect;
+        header << "    {" << r.left << ", " << r.top << ", " << r.width << ", " << r.height << "}, // "
+               << sprites[i].file << "\n";
+    }
+    header << "};\n";
+    return true;
+}
+int main(int argc, char* argv[])
+{
+    if (argc < 5)
+    {
+        cerr << "Usage: atlas_packer <atlas.png> <atlas_rects.h> <image dir> NAME=file.png ..." << endl;
+        return 1;
+    }
+    string imageDir = argv[3];
+    vector<PackedSprite> sprites;
+    for (int i = 4; i < argc; i++)
+    {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (eq == string::npos)
+        {
+            cerr << "Expected NAME=file.png, got " << arg << endl;
+            return 1;
+        }
+        PackedSprite sprite;
+        sprite.name = arg.substr(0, eq);
+        sprite.file = arg.substr(eq + 1);
+        if (!sprite.image.loadFromFile(imageDir + "/" + sprite.file))
+        {
+            cerr << "Failed to load " << imageDir << "/" << sprite.file << endl;
+            return 1;
+        }
+        sprites.push_back(sprite);
+    }
+    int height = packShelves(sprites);
+    Image atlas;
+    atlas.create(ATLAS_WIDTH, height, Color::Transparent);
+    for (size_t i = 0; i < sprites.size(); i++)
+    {
+        atlas.copy(sprites[i].image, sprites[i].rect.left, sprites[i].rect.top);
+    }
+    if (!atlas.saveToFile(argv[1]))
+    {
+        cerr << "Failed to write " << argv[1] << endl;
+        return 1;
+    }
+    // the game finds the atlas next to the other assets
+    string atlasName = argv[1];
+    size_t slash = atlasName.find_last_of("/\\");
+    if (slash != string::npos)
+        atlasName = atlasName.substr(slash + 1);
+    if (!writeHeader(argv[2], sprites, "assets/" + atlasName))
+        return 1;
+    cout << "Packed " << sprites.size() << " sprites into " << ATLAS_WIDTH << "x" << height << " atlas" << endl;
+    return 0;
+}
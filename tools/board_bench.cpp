@@ -0,0 +1,114 @@
+// Fixed size vs runtime size board benchmark
+// Plays the same scripted game on the classic board twice: once on Board<ROWS, COLS> (what the
+// game ships with) and once on the runtime sized board set to the same size. Checks both end up
+// in the same state, then prints ticks/s and raw board sweeps/s for each.
+//
+// Usage: board_bench [ticks] [sweeps]
+#include "game_sim.h"
+// C++ libraries
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <chrono>
+// namespaces
+using namespace std;
+
+// Scripted input, the same for both runs
+SimInput scriptedInput(long tickNumber)
+{
+    uint32_t x = static_cast<uint32_t>(tickNumber) * 2654435761u;
+    x ^= x >> 15;
+    SimInput input;
+    input.left = (x & 3) == 1;
+    input.right = (x & 3) == 2;
+    input.fire = (x & 4) != 0;
+    return input;
+}
+// Play `ticks` ticks, starting a new game whenever one ends. Returns a hash of the final state
+template <class Sim>
+uint64_t playGame(long ticks, double& seconds)
+{
+    Sim sim;
+    sim.setBoardSize(ROWS, COLS);
+    sim.setSeed(7);
+    sim.newGame(3, 0, 1);
+    auto start = chrono::steady_clock::now();
+    for (long i = 0; i < ticks; i++)
+    {
+        int state = sim.tick(scriptedInput(i));
+        if (state == STATE_LEVEL_UP)
+            sim.restartTimers();
+        else if (state == STATE_GAME_OVER || state == STATE_VICTORY)
+            sim.newGame(3, 0, 1 + static_cast<int>(i % MAX_LEVEL));
+    }
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    uint64_t hash = 1469598103934665603ull;
+    for (int r = 0; r < ROWS; r++)
+    {
+        for (int c = 0; c < COLS; c++)
+        {
+            hash = (hash ^ static_cast<uint64_t>(cellAt(sim.board, r, c))) * 1099511628211ull;
+        }
+    }
+    hash = (hash ^ static_cast<uint64_t>(sim.score)) * 1099511628211ull;
+    return (hash ^ static_cast<uint64_t>(sim.level)) * 1099511628211ull;
+}
+// Sweep a board that is a third full with everything moving, refilling the top row as it drains
+template <class Sim>
+double sweepRate(int sweeps)
+{
+    Sim sim;
+    sim.setBoardSize(ROWS, COLS);
+    sim.newGame(1000000, 0, MAX_LEVEL); // no level ups, they would clear the board
+    Pcg32 fill;
+    seedRandom(fill, 11, 0);
+    for (int r = 0; r < ROWS - 1; r++)
+    {
+        for (int c = 0; c < COLS; c++)
+        {
+            if (randomBelow(fill, 3) == 0)
+                setCell(sim.board, r, c, CELL_METEOR + randomBelow(fill, 5));
+        }
+    }
+    unsigned everything = typeBit(CELL_METEOR) | typeBit(CELL_BULLET) | typeBit(CELL_ENEMY) |
+                          typeBit(CELL_BOSS) | typeBit(CELL_BOSS_BULLET);
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < sweeps; i++)
+    {
+        int c = i % COLS;
+        if (cellAt(sim.board, 0, c) == CELL_EMPTY)
+            addCell(sim.board, CELL_METEOR, 0, c);
+        sim.sweepBoard(everything);
+        sim.dispatchEvents();
+    }
+    return sweeps / chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    long ticks = argc > 1 ? atol(argv[1]) : 2000000;
+    int sweeps = argc > 2 ? atoi(argv[2]) : 2000000;
+    if (ticks < 1 || sweeps < 1)
+    {
+        cerr << "Usage: board_bench [ticks] [sweeps]" << endl;
+        return 1;
+    }
+    double fixedSeconds, runtimeSeconds;
+    uint64_t fixedHash = playGame<GameSim>(ticks, fixedSeconds);
+    uint64_t runtimeHash = playGame<BigGameSim>(ticks, runtimeSeconds);
+    if (fixedHash != runtimeHash)
+    {
+        cerr << "Fixed and runtime boards played different games" << endl;
+        return 1;
+    }
+    double fixedSweeps = sweepRate<GameSim>(sweeps);
+    double runtimeSweeps = sweepRate<BigGameSim>(sweeps);
+
+    cout << ROWS << "x" << COLS << " board, " << ticks << " ticks, " << sweeps << " sweeps" << endl;
+    cout << "Board<" << ROWS << ", " << COLS << ">: " << ticks / fixedSeconds << " ticks/s, "
+         << fixedSweeps << " sweeps/s" << endl;
+    cout << "runtime size:   " << ticks / runtimeSeconds << " ticks/s, " << runtimeSweeps << " sweeps/s" << endl;
+    cout << "fixed / runtime: x" << runtimeSeconds / fixedSeconds << " ticks, x" << fixedSweeps / runtimeSweeps
+         << " sweeps" << endl;
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Headless board stress run
+// Fills a big board with falling entities and bullets and times board sweeps with 1, 2, 4, ...
+// threads, to see how the row band split scales. Only the sweep itself is in the scaling numbers:
+// refilling the edges and dispatching the collisions run on one thread, they are timed on their own
+// and reported next to it.
+//
+// Usage: board_stress [rows] [cols] [sweeps] [max threads]
+#include "game_sim.h"
+#include "worker_pool.h"
+// C++ libraries
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+// namespaces
+using namespace std;
+
+const int FILL_PERCENT = 30; // how much of the board starts occupied
+
+int randomFaller(Pcg32& rng)
+{
+    const int fallers[] = {CELL_METEOR, CELL_ENEMY, CELL_BOSS, CELL_BOSS_BULLET};
+    return fallers[randomBelow(rng, 4)];
+}
+void fillBoard(DynamicBoard& board, Pcg32& rng)
+{
+    for (int r = 0; r < board.rowCount - 1; r++)
+    {
+        for (int c = 0; c < board.colCount; c++)
+        {
+            if (randomBelow(rng, 100) >= FILL_PERCENT)
+                continue;
+            setCell(board, r, c, randomBelow(rng, 4) == 0 ? CELL_BULLET : randomFaller(rng));
+        }
+    }
+}
+// Keep the load steady: new fallers at the top, new bullets at the bottom
+void refillEdges(DynamicBoard& board, Pcg32& rng)
+{
+    for (int c = 0; c < board.colCount; c++)
+    {
+        if (randomBelow(rng, 100) < FILL_PERCENT && cellAt(board, 0, c) == CELL_EMPTY)
+            addCell(board, randomFaller(rng), 0, c);
+        if (randomBelow(rng, 100) < FILL_PERCENT && cellAt(board, board.rowCount - 2, c) == CELL_EMPTY)
+            addCell(board, CELL_BULLET, board.rowCount - 2, c);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int rows = argc > 1 ? atoi(argv[1]) : 1024;
+    int cols = argc > 2 ? atoi(argv[2]) : 1024;
+    int sweeps = argc > 3 ? atoi(argv[3]) : 200;
+    int maxThreads = argc > 4 ? atoi(argv[4]) : static_cast<int>(thread::hardware_concurrency());
+    if (rows < 3 || cols < 1 || sweeps < 1 || maxThreads < 1)
+    {
+        cerr << "Usage: board_stress [rows] [cols] [sweeps] [max threads]" << endl;
+        return 1;
+    }
+    unsigned everything = typeBit(CELL_METEOR) | typeBit(CELL_BULLET) | typeBit(CELL_ENEMY) |
+                          typeBit(CELL_BOSS) | typeBit(CELL_BOSS_BULLET);
+    cout << rows << "x" << cols << " board, " << sweeps << " sweeps" << endl;
+    double oneThread = 0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        WorkerPool pool(threads);
+        BigGameSim sim;
+        sim.setBoardSize(rows, cols);
+        sim.workers = &pool;
+        sim.newGame(1000000, 0, MAX_LEVEL); // no level ups, they would clear the board
+        Pcg32 fill; // same board for every thread count
+        seedRandom(fill, 1, 0);
+        fillBoard(sim.board, fill);
+        double seconds = 0, refillSeconds = 0, dispatchSeconds = 0;
+        for (int i = 0; i < sweeps; i++)
+        {
+            auto start = chrono::steady_clock::now();
+            refillEdges(sim.board, fill);
+            auto sweepStart = chrono::steady_clock::now();
+            sim.sweepBoard(everything);
+            auto sweepEnd = chrono::steady_clock::now();
+            sim.dispatchEvents();
+            auto end = chrono::steady_clock::now();
+            refillSeconds += chrono::duration<double>(sweepStart - start).count();
+            seconds += chrono::duration<double>(sweepEnd - sweepStart).count();
+            dispatchSeconds += chrono::duration<double>(end - sweepEnd).count();
+        }
+        double cellsPerSecond = static_cast<double>(rows) * cols * sweeps / seconds;
+        if (threads == 1)
+            oneThread = cellsPerSecond;
+        cout << threads << " threads: " << sweeps / seconds << " sweeps/s, " << cellsPerSecond / 1e6
+             << " Mcells/s, x" << cellsPerSecond / oneThread << endl;
+        cout << "  serial, not in the above: refill " << refillSeconds * 1000.0 / sweeps << " ms/sweep, dispatch "
+             << dispatchSeconds * 1000.0 / sweeps << " ms/sweep" << endl;
+        if (threads < maxThreads && threads * 2 > maxThreads) // always finish on the full count
+            threads = maxThreads / 2;
+    }
+    return 0;
+}
@@ -0,0 +1,182 @@
+// Collision check
+// Golden tests for the collision rules. Every moving type is stepped into a cell holding each type
+// (and off the board) on an otherwise empty board, on both boards the rules are compiled for, and
+// the outcome (what holds the cell, lives, score, kills, explosions) is compared with the table below.
+// Then a scripted game on a fixed seed has to end on the tick, with the score, kills, level and lives
+// pinned here.
+//
+// Usage: collision_check (exit code 0 when every outcome matched, ctest runs it)
+#include "game_sim.h"
+// C++ libraries
+#include <iostream>
+// namespaces
+using namespace std;
+
+const char* CELL_NAMES[CELL_TYPES] = {"empty", "player", "meteor", "bullet", "enemy", "boss", "boss bullet"};
+const int TEST_ROW = 6; // the mover steps into (TEST_ROW, TEST_COL), away from every edge
+const int TEST_COL = 7;
+
+struct Outcome
+{
+    int mover;
+    int occupant;  // OFF_BOARD: the mover starts on the edge it moves towards
+    int holder;    // what is in the cell afterwards
+    int livesLost;
+    int minPoints; // meteors are worth 1 or 2
+    int maxPoints;
+    int kills;
+    int effects;   // explosions left in the cell
+};
+// Movers into their own kind are left out: the whole kind moves together
+const Outcome OUTCOMES[] = {
+    // mover, occupant, holder afterwards, lives lost, points, kills, explosions
+    {CELL_METEOR, CELL_EMPTY, CELL_METEOR, 0, 0, 0, 0, 0},
+    {CELL_METEOR, CELL_PLAYER, CELL_PLAYER, 1, 0, 0, 0, 0},
+    {CELL_METEOR, CELL_BULLET, CELL_EMPTY, 0, 1, 2, 0, 1},
+    {CELL_METEOR, CELL_ENEMY, CELL_ENEMY, 0, 0, 0, 0, 0},
+    {CELL_METEOR, CELL_BOSS, CELL_BOSS, 0, 0, 0, 0, 0},
+    {CELL_METEOR, CELL_BOSS_BULLET, CELL_BOSS_BULLET, 0, 0, 0, 0, 0},
+    {CELL_METEOR, OFF_BOARD, CELL_EMPTY, 0, 0, 0, 0, 0},
+    {CELL_BULLET, CELL_EMPTY, CELL_BULLET, 0, 0, 0, 0, 0},
+    {CELL_BULLET, CELL_PLAYER, CELL_PLAYER, 0, 0, 0, 0, 0},
+    {CELL_BULLET, CELL_METEOR, CELL_EMPTY, 0, 1, 2, 0, 1},
+    {CELL_BULLET, CELL_ENEMY, CELL_EMPTY, 0, 3, 3, 1, 1},
+    {CELL_BULLET, CELL_BOSS, CELL_EMPTY, 0, 5, 5, 1, 1},
+    {CELL_BULLET, CELL_BOSS_BULLET, CELL_EMPTY, 0, 0, 0, 0, 1},
+    {CELL_BULLET, OFF_BOARD, CELL_EMPTY, 0, 0, 0, 0, 0},
+    {CELL_ENEMY, CELL_EMPTY, CELL_ENEMY, 0, 0, 0, 0, 0},
+    {CELL_ENEMY, CELL_PLAYER, CELL_PLAYER, 1, 0, 0, 0, 0},
+    {CELL_ENEMY, CELL_METEOR, CELL_METEOR, 0, 0, 0, 0, 0},
+    {CELL_ENEMY, CELL_BULLET, CELL_EMPTY, 0, 3, 3, 1, 1},
+    {CELL_ENEMY, CELL_BOSS, CELL_BOSS, 0, 0, 0, 0, 0},
+    {CELL_ENEMY, CELL_BOSS_BULLET, CELL_BOSS_BULLET, 0, 0, 0, 0, 0},
+    {CELL_ENEMY, OFF_BOARD, CELL_EMPTY, 1, 0, 0, 0, 0},
+    {CELL_BOSS, CELL_EMPTY, CELL_BOSS, 0, 0, 0, 0, 0},
+    {CELL_BOSS, CELL_PLAYER, CELL_PLAYER, 1, 0, 0, 0, 0},
+    {CELL_BOSS, CELL_METEOR, CELL_BOSS, 0, 0, 0, 0, 0},
+    {CELL_BOSS, CELL_BULLET, CELL_EMPTY, 0, 5, 5, 1, 1},
+    {CELL_BOSS, CELL_ENEMY, CELL_BOSS, 0, 0, 0, 0, 0},
+    {CELL_BOSS, CELL_BOSS_BULLET, CELL_BOSS, 0, 0, 0, 0, 0},
+    {CELL_BOSS, OFF_BOARD, CELL_EMPTY, 1, 0, 0, 0, 0},
+    {CELL_BOSS_BULLET, CELL_EMPTY, CELL_BOSS_BULLET, 0, 0, 0, 0, 0},
+    {CELL_BOSS_BULLET, CELL_PLAYER, CELL_PLAYER, 1, 0, 0, 0, 1},
+    {CELL_BOSS_BULLET, CELL_METEOR, CELL_BOSS_BULLET, 0, 0, 0, 0, 0},
+    {CELL_BOSS_BULLET, CELL_BULLET, CELL_BULLET, 0, 0, 0, 0, 0},
+    {CELL_BOSS_BULLET, CELL_ENEMY, CELL_BOSS_BULLET, 0, 0, 0, 0, 0},
+    {CELL_BOSS_BULLET, CELL_BOSS, CELL_BOSS, 0, 0, 0, 0, 0},
+    {CELL_BOSS_BULLET, OFF_BOARD, CELL_EMPTY, 0, 0, 0, 0, 0},
+};
+
+// A scripted game on a fixed seed and what it has to end with
+const uint64_t GOLDEN_SEED = 2024;
+const int GOLDEN_START_LIVES = 20;
+const int GOLDEN_START_LEVEL = 2; // climbs into the levels with bosses, boss bullets and shields
+const int GOLDEN_MAX_TICKS = 180 * TICK_RATE;
+// where the rules as they are now take it: game over on level 3
+const int GOLDEN_END_TICKS = 10752;
+const int GOLDEN_SCORE = 159;
+const int GOLDEN_KILLS = 22;
+const int GOLDEN_LEVEL = 3;
+const int GOLDEN_LIVES = 0;
+
+// Input that changes every few ticks, so the player moves and shoots all over the board
+SimInput scriptedInput(long tick)
+{
+    SimInput input;
+    input.left = (tick / 37) % 3 == 0;
+    input.right = (tick / 41) % 3 == 1;
+    input.fire = (tick / 13) % 4 != 0;
+    return input;
+}
+
+// One mover stepping into one occupant, `shielded`: the player has a shield up
+template <class SimT>
+bool checkOutcome(const char* boardName, const Outcome& expected, bool shielded)
+{
+    SimT sim;
+    sim.setSeed(DEFAULT_SEED);
+    sim.newGame(3, 0, 3);
+    clearGrid(sim.board);
+    sim.hasShield = shielded;
+    bool up = expected.mover == CELL_BULLET;
+    int row = TEST_ROW;
+    int from = up ? row + 1 : row - 1;
+    if (expected.occupant == OFF_BOARD)
+    {
+        row = up ? -1 : sim.board.rowCount;
+        from = up ? 0 : sim.board.rowCount - 1;
+    }
+    else if (expected.occupant != CELL_EMPTY)
+        setCell(sim.board, row, TEST_COL, expected.occupant);
+    setCell(sim.board, from, TEST_COL, expected.mover);
+    sim.beginStep(0.0f);
+    sim.sweepBoard(typeBit(expected.mover));
+    sim.dispatchEvents();
+
+    int livesLost = 3 - sim.lives;
+    bool onBoard = row >= 0 && row < sim.board.rowCount;
+    int holder = onBoard ? cellAt(sim.board, row, TEST_COL) : CELL_EMPTY;
+    int wantLives = expected.livesLost;
+    if (shielded && wantLives > 0)
+        wantLives = 0; // the shield takes the hit instead
+    bool ok = holder == expected.holder && cellAt(sim.board, from, TEST_COL) == CELL_EMPTY &&
+              livesLost == wantLives && sim.score >= expected.minPoints && sim.score <= expected.maxPoints &&
+              sim.killCount == expected.kills && sim.hitEffects.liveCount == expected.effects &&
+              sim.hasShield == (shielded && expected.livesLost == 0) && sim.isInvincible == (expected.livesLost > 0);
+    if (!ok)
+    {
+        cout << boardName << ": " << CELL_NAMES[expected.mover] << " into "
+             << (expected.occupant == OFF_BOARD ? "the edge" : CELL_NAMES[expected.occupant])
+             << (shielded ? " (shielded)" : "") << " left " << CELL_NAMES[holder] << ", " << livesLost
+             << " lives lost, " << sim.score << " points, " << sim.killCount << " kills, "
+             << sim.hitEffects.liveCount << " explosions - MISMATCH" << endl;
+    }
+    return ok;
+}
+template <class SimT>
+int checkOutcomes(const char* boardName)
+{
+    int failures = 0;
+    for (const Outcome& expected : OUTCOMES)
+    {
+        failures += !checkOutcome<SimT>(boardName, expected, false);
+        failures += !checkOutcome<SimT>(boardName, expected, true);
+    }
+    cout << boardName << ": " << sizeof(OUTCOMES) / sizeof(OUTCOMES[0]) << " collisions, with and without a shield - "
+         << (failures == 0 ? "ok" : "MISMATCH") << endl;
+    return failures;
+}
+
+int main()
+{
+    int failures = checkOutcomes<GameSim>("classic board");
+    failures += checkOutcomes<BigGameSim>("dynamic board");
+
+    GameSim sim;
+    sim.setSeed(GOLDEN_SEED);
+    sim.newGame(GOLDEN_START_LIVES, 0, GOLDEN_START_LEVEL);
+    int ticks = 0;
+    while (ticks < GOLDEN_MAX_TICKS)
+    {
+        int state = sim.tick(scriptedInput(ticks));
+        ticks++;
+        if (state == STATE_LEVEL_UP)
+            sim.restartTimers(); // what the level up screen does before play goes on
+        else if (state != STATE_PLAYING)
+            break;
+    }
+    cout << "seed " << GOLDEN_SEED << ": " << ticks << " ticks, score " << sim.score << ", kills " << sim.killCount
+         << ", level " << sim.level << ", lives " << sim.lives;
+    if (ticks == GOLDEN_END_TICKS && sim.score == GOLDEN_SCORE && sim.killCount == GOLDEN_KILLS &&
+        sim.level == GOLDEN_LEVEL && sim.lives == GOLDEN_LIVES)
+    {
+        cout << " - ok" << endl;
+    }
+    else
+    {
+        cout << " - MISMATCH, expected " << GOLDEN_END_TICKS << " ticks, score " << GOLDEN_SCORE << ", kills "
+             << GOLDEN_KILLS << ", level " << GOLDEN_LEVEL << ", lives " << GOLDEN_LIVES << endl;
+        failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
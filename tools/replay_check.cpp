@@ -0,0 +1,56 @@
+// Headless replay player
+// Re-simulates recorded sessions as fast as the CPU allows and checks each one ends with the
+// score, kills and level it was recorded with.
+//
+// Usage: replay_check replay-file [replay-file...]
+#include "replay.h"
+// C++ libraries
+#include <iostream>
+#include <chrono>
+// namespaces
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "Usage: replay_check replay-file [replay-file...]" << endl;
+        return 1;
+    }
+    int failures = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        Replay replay;
+        if (!loadReplay(replay, argv[i]))
+        {
+            cerr << argv[i] << ": not a replay file" << endl;
+            failures++;
+            continue;
+        }
+        GameSim sim;
+        auto start = chrono::steady_clock::now();
+        long ticks = playReplay(sim, replay);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << argv[i] << ": seed " << replay.seed << ", " << ticks << " ticks ("
+             << ticks / static_cast<double>(TICK_RATE) << "s of play) in " << seconds * 1000.0 << "ms, "
+             << ticks / seconds << " ticks/s" << endl;
+        cout << "  score " << sim.score << ", kills " << sim.killCount << ", level " << sim.level;
+        if (!replay.finished)
+        {
+            cout << " (recording was cut short, nothing to check against)" << endl;
+            continue;
+        }
+        if (sim.score == replay.endScore && sim.killCount == replay.endKills && sim.level == replay.endLevel &&
+            ticks == replay.ticks)
+        {
+            cout << " - matches the recording" << endl;
+        }
+        else
+        {
+            cout << " - MISMATCH, recorded score " << replay.endScore << ", kills " << replay.endKills << ", level "
+                 << replay.endLevel << " after " << replay.ticks << " ticks" << endl;
+            failures++;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
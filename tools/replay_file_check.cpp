@@ -0,0 +1,147 @@
+// Replay file check
+// Records a scripted session, writes it as a replay file and reads it back: it has to load field for
+// field and play back to the score, kills and level it was recorded with. Damaged files have to be
+// refused: a varint cut off in the middle or running past 64 bits, another magic or version, a header
+// no game starts with. A file cut off between records is a session cut short and loads unfinished.
+//
+// Usage: replay_file_check (exit code 0 when every case came out right, ctest runs it)
+#include "replay.h"
+#include "file_writer.h"
+// C++ libraries
+#include <iostream>
+#include <cstdio>
+// namespaces
+using namespace std;
+
+const char TEST_FILE[] = "replay_file_check.rpl";
+const uint64_t TEST_SEED = 0x123456789abcdefull; // a seed that takes every byte of its varint
+const int RECORDED_TICKS = 4000;
+
+int failures = 0;
+
+void check(const char* name, bool ok)
+{
+    cout << name << " - " << (ok ? "ok" : "FAILED") << endl;
+    failures += !ok;
+}
+// Input that changes every few ticks, so the player moves and shoots all over the board
+SimInput scriptedInput(long tick)
+{
+    SimInput input;
+    input.left = (tick / 37) % 3 == 0;
+    input.right = (tick / 41) % 3 == 1;
+    input.fire = (tick / 13) % 4 != 0;
+    return input;
+}
+void appendVarint(vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+// A header by hand, followed by `seedBytes` in place of the seed
+vector<uint8_t> header(const vector<uint8_t>& seedBytes, uint64_t lives, uint64_t score, uint64_t level)
+{
+    vector<uint8_t> bytes = {'S', 'S', 'R', 'P', REPLAY_VERSION};
+    bytes.insert(bytes.end(), seedBytes.begin(), seedBytes.end());
+    appendVarint(bytes, lives);
+    appendVarint(bytes, score);
+    appendVarint(bytes, level);
+    return bytes;
+}
+bool loadBytes(const vector<uint8_t>& bytes, Replay& replay)
+{
+    writeFileAtomically(TEST_FILE, bytes);
+    return loadReplay(replay, TEST_FILE);
+}
+
+int main()
+{
+    // a session like the front end records it: a pause, level ups, and the end
+    GameSim sim;
+    Replay recorded;
+    sim.setSeed(TEST_SEED);
+    sim.newGame(20, 0, 2);
+    startRecording(recorded, TEST_SEED, 20, 0, 2);
+    for (int t = 0; t < RECORDED_TICKS; t++)
+    {
+        if (t == 500)
+        {
+            recordCommand(recorded, REPLAY_PAUSE);
+            recordCommand(recorded, REPLAY_RESUME);
+        }
+        SimInput input = scriptedInput(t);
+        int state = sim.tick(input);
+        recordTicks(recorded, input, 1);
+        if (state == STATE_LEVEL_UP)
+        {
+            sim.restartTimers();
+            recordCommand(recorded, REPLAY_RESTART_TIMERS);
+        }
+        else if (state != STATE_PLAYING)
+            break;
+    }
+    finishRecording(recorded, sim);
+    const vector<uint8_t> good = encodeReplay(recorded);
+
+    Replay loaded;
+    bool ok = loadBytes(good, loaded);
+    check("round trip", ok && loaded.seed == TEST_SEED && loaded.startLives == 20 && loaded.startScore == 0 &&
+                            loaded.startLevel == 2 && loaded.records == recorded.records &&
+                            loaded.ticks == recorded.ticks && loaded.finished && loaded.endScore == recorded.endScore &&
+                            loaded.endKills == recorded.endKills && loaded.endLevel == recorded.endLevel);
+    GameSim played;
+    long ticks = playReplay(played, loaded);
+    cout << "  " << ticks << " ticks, score " << played.score << ", kills " << played.killCount << ", level "
+         << played.level << endl;
+    check("plays back to the recorded end", ticks == recorded.ticks && played.score == recorded.endScore &&
+                                                played.killCount == recorded.endKills &&
+                                                played.level == recorded.endLevel);
+
+    // every shorter file: cut between records it is a session cut short, anywhere else it is refused
+    size_t headerSize = good.size() - recorded.records.size();
+    bool cutsRight = true;
+    for (size_t size = 0; size < good.size(); size++)
+    {
+        vector<uint8_t> cut(good.begin(), good.begin() + size);
+        bool midVarint = size > 0 && (good[size - 1] & 0x80);
+        bool loadedCut = loadBytes(cut, loaded);
+        if (midVarint || size < headerSize)
+            cutsRight = cutsRight && !loadedCut;
+        else if (loadedCut)
+            cutsRight = cutsRight && !loaded.finished;
+    }
+    check("cut files refused or unfinished", cutsRight);
+
+    vector<uint8_t> bytes = good;
+    bytes[0] = 'X';
+    check("another magic refused", !loadBytes(bytes, loaded));
+    bytes = good;
+    bytes[4] = REPLAY_VERSION + 1;
+    check("another version refused", !loadBytes(bytes, loaded));
+    check("empty file refused", !loadBytes(vector<uint8_t>(), loaded));
+
+    vector<uint8_t> seed;
+    appendVarint(seed, TEST_SEED);
+    check("hand made header read", loadBytes(header(seed, 3, 0, 1), loaded) && loaded.seed == TEST_SEED &&
+                                       loaded.ticks == 0 && !loaded.finished);
+    vector<uint8_t> widest(9, 0xff);
+    widest.push_back(0x01); // 2^64 - 1
+    check("64 bit varint read", loadBytes(header(widest, 3, 0, 1), loaded) && loaded.seed == ~0ull);
+    vector<uint8_t> overflow(9, 0xff);
+    overflow.push_back(0x02); // bit 64
+    check("varint past 64 bits refused", !loadBytes(header(overflow, 3, 0, 1), loaded));
+    vector<uint8_t> endless(11, 0x80);
+    endless.push_back(0x00);
+    check("varint of 12 bytes refused", !loadBytes(header(endless, 3, 0, 1), loaded));
+    check("no lives refused", !loadBytes(header(seed, 0, 0, 1), loaded));
+    check("level 0 refused", !loadBytes(header(seed, 3, 0, 0), loaded));
+    check("level past the last refused", !loadBytes(header(seed, 3, 0, MAX_LEVEL + 1), loaded));
+    check("score past an int refused", !loadBytes(header(seed, 3, 1ull << 40, 1), loaded));
+    remove(TEST_FILE);
+    check("missing file refused", !loadReplay(loaded, TEST_FILE));
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+// Rewind check
+// Plays a scripted game long enough for the rewind ring to wrap, keeping a SimSnapshot of every tick
+// next to the rewind buffer. Then rewinds by steps of many sizes: within a group, onto and across
+// keyframes, back to the oldest tick the ring still holds, and again after playing on from a rewind.
+// Every state it lands on has to match the snapshot of that tick byte for byte.
+//
+// Usage: rewind_check (exit code 0 when every state matched, ctest runs it)
+#include "rewind.h"
+// C++ libraries
+#include <iostream>
+#include <cstring>
+#include <vector>
+// namespaces
+using namespace std;
+
+const int PLAYED_TICKS = (REWIND_GROUPS + 10) * REWIND_KEYFRAME_INTERVAL; // the ring wraps ten times over
+
+// Input that changes every few ticks, so the player moves and shoots all over the board
+SimInput scriptedInput(long tick)
+{
+    SimInput input;
+    input.left = (tick / 37) % 3 == 0;
+    input.right = (tick / 41) % 3 == 1;
+    input.fire = (tick / 13) % 4 != 0;
+    return input;
+}
+void playTicks(GameSim& sim, RewindBuffer& rewind, vector<SimSnapshot>& history, int ticks)
+{
+    for (int i = 0; i < ticks; i++)
+    {
+        sim.tick(scriptedInput(static_cast<long>(history.size())));
+        recordRewind(rewind, sim);
+        history.emplace_back();
+        captureSnapshot(sim, history.back());
+    }
+}
+// Rewind `ticks` and compare with the recorded tick it should land on
+bool checkRewind(GameSim& sim, RewindBuffer& rewind, vector<SimSnapshot>& history, int ticks)
+{
+    long held = rewind.ticks;
+    int gone = rewindTicks(rewind, sim, ticks);
+    int expected = static_cast<int>(min<long>(ticks, held - 1));
+    SimSnapshot landed;
+    captureSnapshot(sim, landed);
+    size_t index = history.size() - 1 - gone;
+    bool ok = gone == expected && memcmp(&landed, &history[index], sizeof(landed)) == 0;
+    cout << "back " << ticks << ": went " << gone << " ticks to tick " << index << ", " << rewind.ticks
+         << " held - " << (ok ? "ok" : "MISMATCH") << endl;
+    history.resize(index + 1); // later ticks are gone from the buffer too
+    return ok;
+}
+
+int main()
+{
+    RewindBuffer rewind;
+    initRewind(rewind);
+    GameSim sim;
+    sim.setSeed(12345);
+    sim.newGame(1000000, 0, 3); // from level 3 on bosses, boss bullets and shields show up
+    vector<SimSnapshot> history;
+    int failures = 0;
+
+    playTicks(sim, rewind, history, PLAYED_TICKS);
+    cout << PLAYED_TICKS << " ticks played, " << rewind.ticks << " held in " << rewindBytes(rewind) << " bytes" << endl;
+    if (rewind.ticks < REWIND_SECONDS * TICK_RATE)
+    {
+        cout << "holds less than " << REWIND_SECONDS << "s - MISMATCH" << endl;
+        failures++;
+    }
+    // single ticks, a whole group, across several keyframes
+    const int steps[] = {1, 1, 7, REWIND_KEYFRAME_INTERVAL - 1, 1, REWIND_KEYFRAME_INTERVAL, 250, 1000};
+    for (int ticks : steps)
+    {
+        failures += !checkRewind(sim, rewind, history, ticks);
+    }
+    // play on from the rewound state, past a few keyframes, and go back over both
+    playTicks(sim, rewind, history, 5 * REWIND_KEYFRAME_INTERVAL + 17);
+    failures += !checkRewind(sim, rewind, history, 3 * REWIND_KEYFRAME_INTERVAL);
+    failures += !checkRewind(sim, rewind, history, 4 * REWIND_KEYFRAME_INTERVAL);
+    // everything that is left, down to the oldest tick
+    failures += !checkRewind(sim, rewind, history, PLAYED_TICKS);
+    // nothing further back: stays put
+    failures += !checkRewind(sim, rewind, history, 10);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+// Save file check
+// Writes save records and reads them back: a good one has to come back field for field, and a
+// damaged one (flipped byte, cut short, another version or magic, missing) has to be refused.
+// The legacy text save is read only when all four numbers parse and make sense.
+//
+// Usage: save_check (exit code 0 when every case came out right, ctest runs it)
+#include "save_file.h"
+#include "file_writer.h"
+// C++ libraries
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+// namespaces
+using namespace std;
+
+const char TEST_FILE[] = "save_check.dat";
+
+int failures = 0;
+
+void check(const char* name, bool ok)
+{
+    cout << name << " - " << (ok ? "ok" : "FAILED") << endl;
+    failures += !ok;
+}
+// Write `bytes` as the save file and try to load it
+bool loadBytes(const vector<uint8_t>& bytes, SaveRecord& record)
+{
+    writeFileAtomically(TEST_FILE, bytes);
+    record = makeSaveRecord(-1, -1, -1, -1);
+    return loadSaveRecord(record, TEST_FILE);
+}
+bool loadText(const char* text, SaveRecord& record)
+{
+    ofstream(TEST_FILE) << text;
+    return loadLegacySave(record, TEST_FILE);
+}
+
+int main()
+{
+    const SaveRecord saved = makeSaveRecord(4210, 2, 187, 4);
+    const vector<uint8_t> good = encodeSaveRecord(saved);
+    SaveRecord loaded;
+
+    bool ok = loadBytes(good, loaded);
+    check("round trip", ok && loaded.highScore == 4210 && loaded.lives == 2 && loaded.score == 187 &&
+                            loaded.level == 4 && loaded.checksum == saved.checksum);
+    ok = loadBytes(encodeSaveRecord(makeSaveRecord(4210, 0, 0, 0)), loaded);
+    check("no game to continue", ok && loaded.highScore == 4210 && loaded.lives == 0);
+
+    bool anyFlipLoaded = false;
+    for (size_t i = 0; i < good.size(); i++)
+    {
+        for (int bit = 0; bit < 8; bit++)
+        {
+            vector<uint8_t> bytes = good;
+            bytes[i] ^= static_cast<uint8_t>(1u << bit);
+            anyFlipLoaded = anyFlipLoaded || loadBytes(bytes, loaded);
+        }
+    }
+    check("every single bit flip refused", !anyFlipLoaded);
+    bool anyCutLoaded = false;
+    for (size_t size = 0; size < good.size(); size++)
+    {
+        anyCutLoaded = anyCutLoaded || loadBytes(vector<uint8_t>(good.begin(), good.begin() + size), loaded);
+    }
+    check("every shorter file refused", !anyCutLoaded);
+
+    // valid checksums over the wrong header
+    SaveRecord other = saved;
+    other.version = SAVE_VERSION + 1;
+    other.checksum = crc32(reinterpret_cast<const uint8_t*>(&other), offsetof(SaveRecord, checksum));
+    check("another version refused", !loadBytes(encodeSaveRecord(other), loaded));
+    other = saved;
+    other.magic[3] = 'X';
+    other.checksum = crc32(reinterpret_cast<const uint8_t*>(&other), offsetof(SaveRecord, checksum));
+    check("another magic refused", !loadBytes(encodeSaveRecord(other), loaded));
+    remove(TEST_FILE);
+    check("missing file refused", !loadSaveRecord(loaded, TEST_FILE));
+
+    ok = loadText("120 3 45 2", loaded);
+    check("legacy save read", ok && loaded.highScore == 120 && loaded.lives == 3 && loaded.score == 45 &&
+                                  loaded.level == 2 && loaded.checksum == makeSaveRecord(120, 3, 45, 2).checksum);
+    check("legacy save with a word refused", !loadText("120 3 lots 2", loaded));
+    check("legacy save cut short refused", !loadText("120 3", loaded));
+    check("legacy save with a negative refused", !loadText("120 -3 45 2", loaded));
+    remove(TEST_FILE);
+    return failures == 0 ? 0 : 1;
+}
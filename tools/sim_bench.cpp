@@ -0,0 +1,284 @@
+// Micro benchmarks for the simulation kernels
+// Times each hot path of a tick on its own (the five move passes, spawning, createExplosionEffect,
+// ageHitEffects, clearEntities, quicksave capture / restore) and a full tick, alone and
+// recorded for rewind, with the board empty, 25% and 75% full. Before every call the kernel's reset
+// puts back only the state it changes (the board, the explosion pool, or the SimSnapshot state for a
+// whole tick) so the density stays what it says; kernels that leave the state as valid as they found
+// it run without one. The reset is timed on its own and taken off; a kernel too fast to tell apart
+// from its reset is reported with the reset included rather than as free. The particle update is timed separately with 1k, 10k
+// and 50k particles alive, reported in particles per millisecond.
+// Results go to stdout and to a JSON file, to compare builds against each other.
+//
+// Usage: bench [output.json] [seconds per benchmark]
+#include "game_sim.h"
+#include "particles.h"
+#include "snapshot.h"
+#include "rewind.h"
+// C++ libraries
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+// namespaces
+using namespace std;
+
+#ifndef BENCH_BUILD_TYPE
+#define BENCH_BUILD_TYPE ""
+#endif
+
+const int DENSITIES[] = {0, 25, 75}; // percent of the cells above the player row
+const int DENSITY_COUNT = 3;
+
+const int PARTICLE_COUNTS[] = {1000, 10000, 50000}; // particles alive while timing
+const int PARTICLE_COUNT_SIZES = 3;
+
+struct BenchResult
+{
+    const char* name;
+    int density;
+    long iterations;
+    double nsPerTick;
+    bool resetIncluded; // too close to the cost of its reset to take that off
+};
+struct ParticleResult
+{
+    int live;
+    long iterations;
+    double nsPerUpdate;
+};
+
+// A game in progress at the given density. Lives and level are maxed so nothing
+// levels up (that would clear the board) or ends the game while timing
+GameSim makeFixture(int density)
+{
+    GameSim sim;
+    sim.setSeed(3);
+    sim.newGame(1000000, 0, MAX_LEVEL);
+    Pcg32 fill;
+    seedRandom(fill, 5, 0);
+    const int types[] = {CELL_METEOR, CELL_BULLET, CELL_ENEMY, CELL_BOSS, CELL_BOSS_BULLET};
+    for (int r = 0; r < ROWS - 1; r++)
+    {
+        for (int c = 0; c < COLS; c++)
+        {
+            if (randomBelow(fill, 100) < density)
+                setCell(sim.board, r, c, types[randomBelow(fill, 5)]);
+        }
+    }
+    // the same share of explosion slots in use
+    for (int i = 0; i < MAX_HIT_EFFECTS * density / 100; i++)
+    {
+        createExplosionEffect(sim.hitEffects, i % ROWS, i % COLS);
+        sim.hitEffects.timer[sim.hitEffects.live[i]] = i % HIT_EFFECT_TICKS; // of every age, a few retire next tick
+    }
+    return sim;
+}
+const int BENCH_REPEATS = 3; // the fastest of these counts, the others caught a context switch or so
+
+// Nanoseconds per call of `kernel`, calling `reset` before every call.
+// Runs batches of growing size until one takes at least `seconds`
+template <class Reset, class Kernel>
+double timeBatches(GameSim& sim, Reset reset, Kernel kernel, double seconds, long& iterations)
+{
+    for (long batch = 64;; batch *= 2)
+    {
+        auto start = chrono::steady_clock::now();
+        for (long i = 0; i < batch; i++)
+        {
+            reset(sim);
+            kernel(sim, i);
+        }
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (elapsed >= seconds)
+        {
+            iterations = batch;
+            return elapsed * 1e9 / batch;
+        }
+    }
+}
+// Fastest of BENCH_REPEATS runs of timeBatches
+template <class Reset, class Kernel>
+double timeKernel(GameSim& sim, Reset reset, Kernel kernel, double seconds, long& iterations)
+{
+    double best = 0;
+    for (int repeat = 0; repeat < BENCH_REPEATS; repeat++)
+    {
+        long batch;
+        double ns = timeBatches(sim, reset, kernel, seconds / BENCH_REPEATS, batch);
+        if (repeat == 0 || ns < best)
+        {
+            best = ns;
+            iterations = batch;
+        }
+    }
+    return best;
+}
+// One 60 fps frame of updateParticles with `live` particles, none of them burning out while timing.
+// Timed a second of frames at a time from a fresh burst, as long as explosion debris lives (any
+// longer and drag slows the particles down to denormals, which real ones never get to)
+ParticleResult benchParticles(int live, double seconds)
+{
+    ParticleSystem burst;
+    initParticles(burst, 7);
+    emitBurst(burst, COLS / 2.0f, ROWS / 2.0f, live, 5.0f, 1e6f, 1.0f, 1.0f, 1.0f);
+    ParticleSystem particles = burst;
+    ParticleResult result;
+    result.live = live;
+    result.iterations = 0;
+    double elapsed = 0;
+    while (elapsed < seconds)
+    {
+        particles = burst;
+        auto start = chrono::steady_clock::now();
+        for (int frame = 0; frame < 60; frame++)
+        {
+            updateParticles(particles, 1.0f / 60);
+        }
+        elapsed += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        result.iterations += 60;
+    }
+    result.nsPerUpdate = elapsed * 1e9 / result.iterations;
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* outputFile = argc > 1 ? argv[1] : "bench.json";
+    double seconds = argc > 2 ? atof(argv[2]) : 0.2;
+    if (seconds <= 0)
+    {
+        cerr << "Usage: bench [output.json] [seconds per benchmark]" << endl;
+        return 1;
+    }
+    vector<BenchResult> results;
+    for (int d = 0; d < DENSITY_COUNT; d++)
+    {
+        int density = DENSITIES[d];
+        const GameSim fixture = makeFixture(density);
+        GameSim sim = fixture;
+        SimSnapshot quick;
+        captureSnapshot(fixture, quick);
+        // resets, each putting back only what its kernels change
+        auto keepState = [](GameSim&) {};
+        auto resetBoard = [&fixture](GameSim& s) {
+            s.board = fixture.board;
+            s.hitEffects = fixture.hitEffects; // collisions leave explosions
+        };
+        auto resetSpawns = [&fixture](GameSim& s) {
+            s.board = fixture.board;
+            for (int i = 0; i < MAX_SHIELD_POWERUPS; i++)
+            {
+                s.shieldPowerupActive[i] = fixture.shieldPowerupActive[i];
+            }
+        };
+        auto resetHitEffects = [&fixture](GameSim& s) { s.hitEffects = fixture.hitEffects; };
+        auto resetGame = [&quick](GameSim& s) { restoreSnapshot(s, quick); }; // everything a tick can change
+        auto bench = [&](const char* name, auto reset, auto kernel) {
+            BenchResult result;
+            result.name = name;
+            result.density = density;
+            long resetIterations;
+            double gross = timeKernel(sim, reset, kernel, seconds, result.iterations);
+            double resetNs = timeKernel(sim, reset, [](GameSim&, long) {}, seconds / 4, resetIterations);
+            result.resetIncluded = gross - resetNs <= 0;
+            result.nsPerTick = result.resetIncluded ? gross : gross - resetNs;
+            results.push_back(result);
+        };
+        bench("move_meteors", resetBoard, [](GameSim& s, long) { s.sweepBoard(typeBit(CELL_METEOR)); s.dispatchEvents(); });
+        bench("move_enemies", resetBoard, [](GameSim& s, long) { s.sweepBoard(typeBit(CELL_ENEMY)); s.dispatchEvents(); });
+        bench("move_bosses", resetBoard, [](GameSim& s, long) { s.sweepBoard(typeBit(CELL_BOSS)); s.dispatchEvents(); });
+        bench("move_boss_bullets", resetBoard,
+              [](GameSim& s, long) { s.sweepBoard(typeBit(CELL_BOSS_BULLET)); s.dispatchEvents(); });
+        bench("move_player_bullets", resetBoard,
+              [](GameSim& s, long) { s.sweepBoard(typeBit(CELL_BULLET)); s.dispatchEvents(); });
+        bench("spawn", resetSpawns, [](GameSim& s, long) {
+            // every spawn timer due at once
+            s.meteorSpawnTicks = s.nextSpawnTicks;
+            s.enemySpawnTicks = s.nextEnemySpawnTicks;
+            s.bossSpawnTicks = s.nextBossSpawnTicks;
+            s.shieldPowerupSpawnTicks = s.nextShieldPowerupSpawnTicks;
+            s.spawnEntities();
+        });
+        bench("create_explosion_effect", resetHitEffects, [](GameSim& s, long i) {
+            createExplosionEffect(s.hitEffects, static_cast<int>(i % ROWS), static_cast<int>(i % COLS));
+        });
+        bench("age_hit_effects", resetHitEffects, [](GameSim& s, long) { ageHitEffects(s.hitEffects); });
+        bench("clear_entities", resetBoard, [](GameSim& s, long) { clearEntities(s.board); });
+        // neither changes the game, no reset needed
+        SimSnapshot captured;
+        bench("capture_snapshot", keepState, [&captured](GameSim& s, long) { captureSnapshot(s, captured); });
+        bench("restore_snapshot", keepState, [&quick](GameSim& s, long) { restoreSnapshot(s, quick); });
+        bench("tick", resetGame, [](GameSim& s, long i) {
+            SimInput input;
+            input.left = (i & 3) == 1;
+            input.right = (i & 3) == 2;
+            input.fire = true;
+            // every subsystem due, so the tick does all of its work
+            s.meteorMoveTicks = s.enemyMoveTicks = s.bossMoveTicks = 1000;
+            s.bossBulletMoveTicks = s.bulletMoveTicks = s.shieldPowerupMoveTicks = 1000;
+            s.tick(input);
+        });
+        RewindBuffer rewind;
+        initRewind(rewind);
+        bench("tick_with_rewind", resetGame, [&rewind](GameSim& s, long i) {
+            SimInput input;
+            input.left = (i & 3) == 1;
+            input.right = (i & 3) == 2;
+            input.fire = true;
+            s.meteorMoveTicks = s.enemyMoveTicks = s.bossMoveTicks = 1000;
+            s.bossBulletMoveTicks = s.bulletMoveTicks = s.shieldPowerupMoveTicks = 1000;
+            s.tick(input);
+            recordRewind(rewind, s);
+        });
+    }
+    vector<ParticleResult> particleResults;
+    for (int i = 0; i < PARTICLE_COUNT_SIZES; i++)
+    {
+        particleResults.push_back(benchParticles(PARTICLE_COUNTS[i], seconds));
+    }
+
+    cout << "build " << (BENCH_BUILD_TYPE[0] ? BENCH_BUILD_TYPE : "(no build type)") << ", " << ROWS << "x"
+         << COLS << " board" << endl;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult& result = results[i];
+        cout << result.name << " @" << result.density << "%: " << result.nsPerTick << " ns/tick, "
+             << 1e9 / result.nsPerTick << " ticks/s" << (result.resetIncluded ? " (reset included)" : "") << endl;
+    }
+    for (size_t i = 0; i < particleResults.size(); i++)
+    {
+        const ParticleResult& result = particleResults[i];
+        cout << "update_particles (" << particleSimd() << ") @" << result.live << " live: " << result.nsPerUpdate
+             << " ns/update, " << result.live / (result.nsPerUpdate / 1e6) << " particles/ms" << endl;
+    }
+    ofstream json(outputFile);
+    if (!json.is_open())
+    {
+        cerr << "Could not write " << outputFile << endl;
+        return 1;
+    }
+    json << "{\n  \"build_type\": \"" << BENCH_BUILD_TYPE << "\",\n  \"rows\": " << ROWS << ",\n  \"cols\": " << COLS
+         << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult& result = results[i];
+        json << "    {\"name\": \"" << result.name << "\", \"density\": " << result.density
+             << ", \"iterations\": " << result.iterations << ", \"ns_per_tick\": " << result.nsPerTick
+             << ", \"ticks_per_second\": " << 1e9 / result.nsPerTick
+             << ", \"reset_included\": " << (result.resetIncluded ? "true" : "false") << "}"
+             << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    json << "  ],\n  \"particle_simd\": \"" << particleSimd() << "\",\n  \"particles\": [\n";
+    for (size_t i = 0; i < particleResults.size(); i++)
+    {
+        const ParticleResult& result = particleResults[i];
+        json << "    {\"live\": " << result.live << ", \"iterations\": " << result.iterations
+             << ", \"ns_per_update\": " << result.nsPerUpdate
+             << ", \"particles_per_ms\": " << result.live / (result.nsPerUpdate / 1e6) << "}"
+             << (i + 1 < particleResults.size() ? ",\n" : "\n");
+    }
+    json << "  ]\n}\n";
+    cout << "Wrote " << outputFile << endl;
+    return 0;
+}
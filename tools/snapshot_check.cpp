@@ -0,0 +1,107 @@
+// Snapshot check
+// Captures a game in progress, writes it as a quicksave file and reads it back. The loaded snapshot
+// has to restore a game that carries on tick for tick like the original, byte for byte in its
+// snapshots; a damaged file (flipped byte, cut short, a byte too many, another version or magic) has
+// to be refused.
+//
+// Usage: snapshot_check (exit code 0 when every case came out right, ctest runs it)
+#include "snapshot.h"
+#include "save_file.h"
+#include "file_writer.h"
+// C++ libraries
+#include <iostream>
+#include <cstring>
+#include <cstddef>
+#include <cstdio>
+// namespaces
+using namespace std;
+
+const char TEST_FILE[] = "snapshot_check.snap";
+const int PLAYED_TICKS = 3000;  // into level 3 territory: bosses, boss bullets, shields, explosions
+const int COMPARED_TICKS = 2000; // played on from the restore
+
+int failures = 0;
+
+void check(const char* name, bool ok)
+{
+    cout << name << " - " << (ok ? "ok" : "FAILED") << endl;
+    failures += !ok;
+}
+// Input that changes every few ticks, so the player moves and shoots all over the board
+SimInput scriptedInput(long tick)
+{
+    SimInput input;
+    input.left = (tick / 37) % 3 == 0;
+    input.right = (tick / 41) % 3 == 1;
+    input.fire = (tick / 13) % 4 != 0;
+    return input;
+}
+bool loadBytes(const vector<uint8_t>& bytes, SimSnapshot& snapshot)
+{
+    writeFileAtomically(TEST_FILE, bytes);
+    return loadSnapshot(snapshot, TEST_FILE);
+}
+// The same snapshot with a changed header, sealed with a valid checksum again
+vector<uint8_t> resealed(SimSnapshot snapshot, uint32_t version, char magic)
+{
+    snapshot.version = version;
+    snapshot.magic[3] = magic;
+    return encodeSnapshot(snapshot);
+}
+
+int main()
+{
+    GameSim original;
+    original.setSeed(77);
+    original.newGame(1000000, 0, 3);
+    for (int t = 0; t < PLAYED_TICKS; t++)
+    {
+        original.tick(scriptedInput(t));
+    }
+    SimSnapshot saved;
+    captureSnapshot(original, saved);
+    saved.saveChecksum = 0x5eed;
+    const vector<uint8_t> good = encodeSnapshot(saved);
+
+    // round trip: the restored game plays on exactly like the one that was saved
+    SimSnapshot loaded;
+    bool ok = loadBytes(good, loaded);
+    check("round trip", ok && memcmp(&loaded, &saved, offsetof(SimSnapshot, checksum)) == 0);
+    GameSim restored;
+    restored.setSeed(1);
+    restored.newGame(3, 0, 1);
+    restored.tick(SimInput()); // something to throw away
+    restoreSnapshot(restored, loaded);
+    bool same = true;
+    for (int t = 0; t < COMPARED_TICKS && same; t++)
+    {
+        original.tick(scriptedInput(PLAYED_TICKS + t));
+        restored.tick(scriptedInput(PLAYED_TICKS + t));
+        SimSnapshot a, b;
+        captureSnapshot(original, a);
+        captureSnapshot(restored, b);
+        same = memcmp(&a, &b, sizeof(a)) == 0;
+    }
+    check("restored game plays on the same", same);
+
+    // a few bits in every field, the whole thing would take a while at 1.6 KB. Up to the end of the
+    // checksum, the padding after it holds no data
+    bool anyFlipLoaded = false;
+    for (size_t i = 0; i < offsetof(SimSnapshot, checksum) + sizeof(saved.checksum); i += 3)
+    {
+        vector<uint8_t> bytes = good;
+        bytes[i] ^= static_cast<uint8_t>(1u << (i % 8));
+        anyFlipLoaded = anyFlipLoaded || loadBytes(bytes, loaded);
+    }
+    check("bit flips refused", !anyFlipLoaded);
+    check("empty file refused", !loadBytes(vector<uint8_t>(), loaded));
+    check("cut short refused", !loadBytes(vector<uint8_t>(good.begin(), good.end() - 1), loaded));
+    vector<uint8_t> longer = good;
+    longer.push_back(0);
+    check("a byte too many refused", !loadBytes(longer, loaded));
+    check("another version refused", !loadBytes(resealed(saved, SNAPSHOT_VERSION + 1, SNAPSHOT_MAGIC[3]), loaded));
+    check("another magic refused", !loadBytes(resealed(saved, SNAPSHOT_VERSION, 'X'), loaded));
+    remove(TEST_FILE);
+    check("missing file refused", !loadSnapshot(loaded, TEST_FILE));
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+#include "trace.h"
+// C++ libraries
+#include <atomic>
+#include <cstdio>
+#include <thread>
+// namespaces
+using namespace std;
+
+const int TRACE_FLUSH_MS = 20; // how often the flush thread drains the ring
+
+bool traceEnabled = false;
+
+// Single producer / single consumer ring: the game thread only moves `head`, the flush thread `tail`
+TraceEvent traceRing[TRACE_CAPACITY];
+atomic<uint32_t> traceHead(0);
+atomic<uint32_t> traceTail(0);
+atomic<bool> traceStopping(false);
+uint64_t traceDropped = 0;
+chrono::steady_clock::time_point traceStart;
+FILE* traceFile = nullptr;
+bool traceFirstEvent = true;
+thread traceFlusher;
+
+void pushTraceEvent(const TraceEvent& event)
+{
+    uint32_t head = traceHead.load(memory_order_relaxed);
+    if (head - traceTail.load(memory_order_acquire) >= static_cast<uint32_t>(TRACE_CAPACITY))
+    {
+        traceDropped++; // flush thread is behind, losing an event beats stalling the frame
+        return;
+    }
+    traceRing[head & (TRACE_CAPACITY - 1)] = event;
+    traceHead.store(head + 1, memory_order_release);
+}
+void writeTraceEvent(const TraceEvent& event)
+{
+    fprintf(traceFile, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":1",
+            traceFirstEvent ? "" : ",", event.name, event.category, event.type, event.startNs / 1000.0);
+    traceFirstEvent = false;
+    if (event.type == 'X')
+        fprintf(traceFile, ",\"dur\":%.3f", event.durationNs / 1000.0);
+    else
+        fprintf(traceFile, ",\"s\":\"t\""); // instant on the thread's track
+    if (event.argNames[0])
+    {
+        fprintf(traceFile, ",\"args\":{");
+        for (int i = 0; i < 2 && event.argNames[i]; i++)
+        {
+            if (event.argTexts[i])
+                fprintf(traceFile, "%s\"%s\":\"%s\"", i ? "," : "", event.argNames[i], event.argTexts[i]);
+            else
+                fprintf(traceFile, "%s\"%s\":%d", i ? "," : "", event.argNames[i], event.argValues[i]);
+        }
+        fprintf(traceFile, "}");
+    }
+    fprintf(traceFile, "}");
+}
+// Write out everything the game thread has pushed so far
+void drainTrace()
+{
+    uint32_t tail = traceTail.load(memory_order_relaxed);
+    uint32_t head = traceHead.load(memory_order_acquire);
+    for (; tail != head; tail++)
+    {
+        writeTraceEvent(traceRing[tail & (TRACE_CAPACITY - 1)]);
+        traceTail.store(tail + 1, memory_order_release); // free the slot straight away
+    }
+}
+void flushLoop()
+{
+    while (!traceStopping.load(memory_order_acquire))
+    {
+        drainTrace();
+        this_thread::sleep_for(chrono::milliseconds(TRACE_FLUSH_MS));
+    }
+    drainTrace();
+}
+
+bool startTrace(const char fileName[])
+{
+    traceFile = fopen(fileName, "w");
+    if (!traceFile)
+        return false;
+    fprintf(traceFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    traceStart = chrono::steady_clock::now();
+    traceStopping = false;
+    traceFlusher = thread(flushLoop);
+    traceEnabled = true;
+    return true;
+}
+void stopTrace()
+{
+    if (!traceEnabled)
+        return;
+    traceEnabled = false;
+    traceStopping.store(true, memory_order_release);
+    traceFlusher.join();
+    fprintf(traceFile, "\n],\"otherData\":{\"dropped_events\":%llu}}\n", static_cast<unsigned long long>(traceDropped));
+    fclose(traceFile);
+    traceFile = nullptr;
+}
+void traceSpan(const char* name, const char* category, chrono::steady_clock::time_point begin,
+               chrono::steady_clock::time_point end)
+{
+    TraceEvent event = {};
+    event.name = name;
+    event.category = category;
+    event.type = 'X';
+    event.startNs = chrono::duration_cast<chrono::nanoseconds>(begin - traceStart).count();
+    event.durationNs = chrono::duration_cast<chrono::nanoseconds>(end - begin).count();
+    pushTraceEvent(event);
+}
+void traceInstant(const char* name, const char* category, const char* argName, int argValue,
+                  const char* secondArgName, int secondArgValue)
+{
+    TraceEvent event = {};
+    event.name = name;
+    event.category = category;
+    event.type = 'i';
+    event.startNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - traceStart).count();
+    event.argNames[0] = argName;
+    event.argValues[0] = argValue;
+    event.argNames[1] = argName ? secondArgName : nullptr;
+    event.argValues[1] = secondArgValue;
+    pushTraceEvent(event);
+}
+void traceTextInstant(const char* name, const char* category, const char* argName, const char* argText,
+                      const char* secondArgName, const char* secondArgText)
+{
+    TraceEvent event = {};
+    event.name = name;
+    event.category = category;
+    event.type = 'i';
+    event.startNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - traceStart).count();
+    event.argNames[0] = argName;
+    event.argTexts[0] = argText;
+    event.argNames[1] = secondArgName;
+    event.argTexts[1] = secondArgText;
+    pushTraceEvent(event);
+}
@@ -0,0 +1,34 @@
+#pragma once
+// Chrome / Perfetto trace export (--trace out.json, open in chrome://tracing or ui.perfetto.dev).
+// The game thread only copies events into a preallocated ring, a flush thread turns them into JSON
+// and writes the file, so tracing never allocates or touches the disk mid-frame. If the flush
+// thread falls behind and the ring fills up, new events are dropped (and counted), never waited on.
+// One producer: events must come from the game thread.
+#include <chrono>
+#include <cstdint>
+
+const int TRACE_CAPACITY = 1 << 15; // events in the ring (power of two)
+
+// One event, only pointers to string literals (the flush thread reads them later)
+struct TraceEvent
+{
+    const char* name;
+    const char* category;
+    char type;             // 'X' span, 'i' instant
+    int64_t startNs;       // since the trace started
+    int64_t durationNs;    // spans only
+    const char* argNames[2];
+    const char* argTexts[2]; // text value of the argument, or nullptr for argValues
+    int argValues[2];
+};
+
+extern bool traceEnabled; // checked before building an event
+
+bool startTrace(const char fileName[]);
+void stopTrace(); // flushes everything left and closes the file
+void traceSpan(const char* name, const char* category, std::chrono::steady_clock::time_point begin,
+               std::chrono::steady_clock::time_point end);
+void traceInstant(const char* name, const char* category, const char* argName = nullptr, int argValue = 0,
+                  const char* secondArgName = nullptr, int secondArgValue = 0);
+void traceTextInstant(const char* name, const char* category, const char* argName, const char* argText,
+                      const char* secondArgName, const char* secondArgText);
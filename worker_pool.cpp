@@ -0,0 +1,73 @@
+#include "worker_pool.h"
+// namespaces
+using namespace std;
+
+WorkerPool::WorkerPool(int threads)
+{
+    for (int i = 1; i < threads; i++) // the caller is thread 0
+    {
+        workers.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+WorkerPool::~WorkerPool()
+{
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i].join();
+    }
+}
+void WorkerPool::run(int taskCount, const function<void(int)>& task)
+{
+    if (workers.empty() || taskCount <= 1) // nothing to share
+    {
+        for (int i = 0; i < taskCount; i++)
+        {
+            task(i);
+        }
+        return;
+    }
+    {
+        lock_guard<std::mutex> lock(mutex);
+        job = &task;
+        jobTasks = taskCount;
+        nextTask = 0;
+        busyWorkers = static_cast<int>(workers.size());
+        jobNumber++;
+    }
+    wake.notify_all();
+    drainTasks(); // help out instead of waiting idle
+    unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return busyWorkers == 0; });
+    job = nullptr;
+}
+void WorkerPool::workerLoop()
+{
+    unsigned seenJob = 0;
+    while (true)
+    {
+        {
+            unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || jobNumber != seenJob; });
+            if (stopping)
+                return;
+            seenJob = jobNumber;
+        }
+        drainTasks();
+        lock_guard<std::mutex> lock(mutex);
+        if (--busyWorkers == 0)
+            finished.notify_one();
+    }
+}
+void WorkerPool::drainTasks()
+{
+    // tasks are claimed one at a time so uneven bands still balance out
+    for (int i = nextTask++; i < jobTasks; i = nextTask++)
+    {
+        (*job)(i);
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+// A fixed set of worker threads that split one job into independent tasks.
+// The board sweep hands it row bands; run() only returns once every task is done.
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkerPool
+{
+public:
+    explicit WorkerPool(int threads); // threads in total, the thread calling run() is one of them
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int threadCount() const { return static_cast<int>(workers.size()) + 1; }
+    // Run task(0) .. task(taskCount - 1) spread over the pool, in any order
+    void run(int taskCount, const std::function<void(int)>& task);
+
+private:
+    void workerLoop();
+    void drainTasks();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;     // a new job was posted (or the pool is stopping)
+    std::condition_variable finished; // the last busy worker is done with the job
+    const std::function<void(int)>* job = nullptr;
+    int jobTasks = 0;
+    std::atomic<int> nextTask{0};
+    int busyWorkers = 0;
+    unsigned jobNumber = 0;
+    bool stopping = false;
+};